@@ -0,0 +1,231 @@
+//****************************************************************************80
+//
+//  PROGRAM    :
+//               GeoT
+//
+//  PURPOSE    :
+//               Program to show Goemetric Transformations as an applied
+//               exploration SFML multimedia library.
+//
+//  PROGRAMMER :
+//               Martín Josemaría <martin.vuelta@gmail.com>
+//
+//               * Software Development and Research
+//                 SoftButterfly
+//                 Lima - Peru
+//
+//               * Faculty of Physical Science
+//                 Universidad Nacional Mayor de San Marcos
+//                 Lima - Peru
+//
+//  FILE       :
+//               batch.cpp
+//
+//  DESCRIPTION:
+//               Work stealing batch runner for headless simulations.
+//
+//****************************************************************************80
+
+#include "batch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <iomanip>
+#include <algorithm>
+
+
+//----------------------------------------------------------------------------80
+//  COLA DE TRABAJO
+//----------------------------------------------------------------------------80
+// Cada hilo recibe un rango contiguo de corridas y las toma desde el frente
+// con una operación atómica. Cuando su rango se agota roba corridas de los
+// rangos de los demás hilos, así ningún hilo queda ocioso mientras otro
+// todavía tiene trabajo y no se usan candados.
+struct alignas(64) WorkRange {
+    std::atomic<unsigned long> next;
+    unsigned long end;
+};
+
+static bool takeRun(WorkRange& range, unsigned long& run) {
+    if (range.next.load(std::memory_order_relaxed) >= range.end) {
+        return false;
+    }
+
+    run = range.next.fetch_add(1, std::memory_order_relaxed);
+
+    return run < range.end;
+}
+
+static BatchResult emptyResult() {
+    BatchResult result;
+
+    result.runs = 0;
+    result.withoutCornerHits = 0;
+    std::fill(result.effects, result.effects + nEffects, 0UL);
+    result.wallBounces = 0;
+    result.obstacleBounces = 0;
+    result.cornerHits = 0;
+    result.threads = 0;
+    result.seconds = 0.0;
+
+    return result;
+}
+
+static void addToHistogram(std::vector<unsigned long>& histogram, std::size_t bin) {
+    if (histogram.size() <= bin) {
+        histogram.resize(bin + 1, 0);
+    }
+
+    histogram[bin]++;
+}
+
+// Una corrida completa, los resultados se acumulan en el estado del hilo
+static void simulate(const Scene& scene, sf::Vector2f fieldOrigin, sf::Vector2f fieldSize, const BatchSettings& settings, unsigned long run, BatchResult& result) {
+    Simulation simulation(scene, fieldOrigin, fieldSize, settings.seed + static_cast<unsigned int>(run));
+
+    simulation.setSpecialEffect(settings.specialEffect);
+    simulation.start();
+
+    // Redondeado: 60 s a 1/60 s son 3600 pasos, no 3599
+    unsigned long steps = static_cast<unsigned long>(std::max(0L, std::lround(settings.duration / settings.deltaTime)));
+
+    for (unsigned long i = 0; i < steps; i++) {
+        simulation.step(settings.deltaTime);
+    }
+
+    const SimulationStats& stats = simulation.getStats();
+    unsigned long bounces = stats.wallBounces + stats.obstacleBounces + stats.cornerHits;
+
+    addToHistogram(result.bounces, bounces / bouncesBinWidth);
+
+    if (stats.firstCornerTime < 0.f) {
+        result.withoutCornerHits++;
+    }
+    else {
+        addToHistogram(result.firstCornerTime, static_cast<std::size_t>(stats.firstCornerTime / cornerTimeBinWidth));
+    }
+
+    for (int effect = 0; effect < nEffects; effect++) {
+        result.effects[effect] += stats.effects[effect];
+    }
+
+    result.wallBounces += stats.wallBounces;
+    result.obstacleBounces += stats.obstacleBounces;
+    result.cornerHits += stats.cornerHits;
+    result.runs++;
+}
+
+static void mergeHistogram(std::vector<unsigned long>& total, const std::vector<unsigned long>& partial) {
+    if (total.size() < partial.size()) {
+        total.resize(partial.size(), 0);
+    }
+
+    for (std::size_t i = 0; i < partial.size(); i++) {
+        total[i] += partial[i];
+    }
+}
+
+
+//----------------------------------------------------------------------------80
+//  MODO POR LOTES
+//----------------------------------------------------------------------------80
+BatchResult runBatch(const Scene& scene, sf::Vector2f fieldOrigin, sf::Vector2f fieldSize, const BatchSettings& settings) {
+    unsigned int nThreads = settings.threads;
+
+    if (nThreads == 0) {
+        nThreads = std::max(1U, std::thread::hardware_concurrency());
+    }
+
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+    // Reparto inicial de las corridas
+    std::vector<WorkRange> ranges(nThreads);
+
+    for (unsigned int i = 0; i < nThreads; i++) {
+        ranges[i].next.store(settings.runs * i / nThreads);
+        ranges[i].end = settings.runs * (i + 1) / nThreads;
+    }
+
+    // Resultados parciales, uno por hilo
+    std::vector<BatchResult> partials(nThreads, emptyResult());
+    std::vector<std::thread> workers;
+
+    for (unsigned int id = 0; id < nThreads; id++) {
+        workers.push_back(std::thread([&, id]() {
+            BatchResult local = emptyResult();
+            unsigned long run;
+
+            for (unsigned int i = 0; i < nThreads; i++) {
+                // Primero el rango propio, luego los de los demás
+                WorkRange& range = ranges[(id + i) % nThreads];
+
+                while (takeRun(range, run)) {
+                    simulate(scene, fieldOrigin, fieldSize, settings, run, local);
+                }
+            }
+
+            partials[id] = local;
+        }));
+    }
+
+    for (auto& worker: workers) {
+        worker.join();
+    }
+
+    // Sumamos los resultados de todos los hilos
+    BatchResult result = emptyResult();
+
+    for (const auto& partial: partials) {
+        mergeHistogram(result.bounces, partial.bounces);
+        mergeHistogram(result.firstCornerTime, partial.firstCornerTime);
+
+        for (int effect = 0; effect < nEffects; effect++) {
+            result.effects[effect] += partial.effects[effect];
+        }
+
+        result.runs += partial.runs;
+        result.withoutCornerHits += partial.withoutCornerHits;
+        result.wallBounces += partial.wallBounces;
+        result.obstacleBounces += partial.obstacleBounces;
+        result.cornerHits += partial.cornerHits;
+    }
+
+    result.threads = nThreads;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    return result;
+}
+
+void printBatchResult(std::ostream& output, const BatchResult& result) {
+    const char* effectNames[nEffects] = {"Homotecia", "Simetria", "Rotacion"};
+
+    output << "runs:             " << result.runs << std::endl;
+    output << "threads:          " << result.threads << std::endl;
+    output << "seconds:          " << result.seconds << std::endl;
+    output << "runs/second:      " << (result.seconds > 0.0 ? static_cast<double>(result.runs) / result.seconds : 0.0) << std::endl;
+    output << "wall bounces:     " << result.wallBounces << std::endl;
+    output << "obstacle bounces: " << result.obstacleBounces << std::endl;
+    output << "corner hits:      " << result.cornerHits << std::endl;
+
+    output << std::endl << "# transformaciones" << std::endl;
+    for (int effect = 0; effect < nEffects; effect++) {
+        output << std::setw(10) << effectNames[effect] << " " << result.effects[effect] << std::endl;
+    }
+
+    output << std::endl << "# rebotes por corrida" << std::endl;
+    for (std::size_t i = 0; i < result.bounces.size(); i++) {
+        if (result.bounces[i] > 0) {
+            output << std::setw(10) << i*bouncesBinWidth << " " << result.bounces[i] << std::endl;
+        }
+    }
+
+    output << std::endl << "# tiempo hasta el primer choque con una esquina (s)" << std::endl;
+    for (std::size_t i = 0; i < result.firstCornerTime.size(); i++) {
+        if (result.firstCornerTime[i] > 0) {
+            output << std::setw(10) << static_cast<float>(i)*cornerTimeBinWidth << " " << result.firstCornerTime[i] << std::endl;
+        }
+    }
+    output << std::setw(10) << "nunca" << " " << result.withoutCornerHits << std::endl;
+}
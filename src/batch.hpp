@@ -0,0 +1,95 @@
+//****************************************************************************80
+//
+//  PROGRAM    :
+//               GeoT
+//
+//  PURPOSE    :
+//               Program to show Goemetric Transformations as an applied
+//               exploration SFML multimedia library.
+//
+//  PROGRAMMER :
+//               Martín Josemaría <martin.vuelta@gmail.com>
+//
+//               * Software Development and Research
+//                 SoftButterfly
+//                 Lima - Peru
+//
+//               * Faculty of Physical Science
+//                 Universidad Nacional Mayor de San Marcos
+//                 Lima - Peru
+//
+//  FILE       :
+//               batch.hpp
+//
+//  DESCRIPTION:
+//               Batch mode: many independent headless simulations run on all
+//               cores and aggregated into histograms.
+//
+//****************************************************************************80
+
+#ifndef GEOT_BATCH_HPP
+#define GEOT_BATCH_HPP
+
+#include <SFML/System.hpp>
+
+#include "scene.hpp"
+#include "simulation.hpp"
+
+#include <ostream>
+#include <vector>
+
+
+//----------------------------------------------------------------------------80
+//  AJUSTES
+//----------------------------------------------------------------------------80
+struct BatchSettings {
+    unsigned long runs;
+
+    // Duración simulada de cada corrida y paso de tiempo
+    float duration;
+    float deltaTime;
+
+    // La corrida i usa la semilla seed + i
+    unsigned int seed;
+
+    // 0: un hilo por núcleo
+    unsigned int threads;
+
+    bool specialEffect;
+};
+
+// Ancho de las clases de los histogramas
+const unsigned long bouncesBinWidth = 10;
+const float cornerTimeBinWidth = 1.f;
+
+
+//----------------------------------------------------------------------------80
+//  RESULTADOS
+//----------------------------------------------------------------------------80
+struct BatchResult {
+    unsigned long runs;
+
+    // Rebotes (paredes, lados de obstáculos y esquinas) por corrida
+    std::vector<unsigned long> bounces;
+
+    // Tiempo hasta el primer choque con una esquina, las corridas sin
+    // choques con esquinas se cuentan aparte
+    std::vector<unsigned long> firstCornerTime;
+    unsigned long withoutCornerHits;
+
+    // Frecuencia de cada transformación
+    unsigned long effects[nEffects];
+
+    unsigned long wallBounces;
+    unsigned long obstacleBounces;
+    unsigned long cornerHits;
+
+    unsigned int threads;
+    double seconds;
+};
+
+BatchResult runBatch(const Scene& scene, sf::Vector2f fieldOrigin, sf::Vector2f fieldSize, const BatchSettings& settings);
+
+void printBatchResult(std::ostream& output, const BatchResult& result);
+
+#endif
@@ -0,0 +1,234 @@
+//****************************************************************************80
+//
+//  PROGRAM    :
+//               GeoT
+//
+//  PURPOSE    :
+//               Program to show Goemetric Transformations as an applied
+//               exploration SFML multimedia library.
+//
+//  PROGRAMMER :
+//               Martín Josemaría <martin.vuelta@gmail.com>
+//
+//               * Software Development and Research
+//                 SoftButterfly
+//                 Lima - Peru
+//
+//               * Faculty of Physical Science
+//                 Universidad Nacional Mayor de San Marcos
+//                 Lima - Peru
+//
+//  FILE       :
+//               flight.cpp
+//
+//  DESCRIPTION:
+//               Always-on flight recorder of the last frames of the main loop.
+//
+//****************************************************************************80
+
+#include "flight.hpp"
+
+#include <cstdio>
+
+#include <iostream>
+
+
+static const char* effectNames[1 + nEffects] = {"Traslacion", "Homotecia", "Simetria", "Rotacion"};
+
+
+//----------------------------------------------------------------------------80
+//  REGISTRADOR DE VUELO
+//----------------------------------------------------------------------------80
+FlightRecorder::FlightRecorder(std::size_t capacity, double frameBudget, const std::string& dumpPrefix) :
+    epoch(std::chrono::steady_clock::now()),
+    budget(1e6*frameBudget),
+    prefix(dumpPrefix),
+    frames(capacity > 0 ? capacity : 1),
+    next(0),
+    count(0),
+    frameIndex(0),
+    sinceDump(0),
+    pending(frames.size()),
+    pendingCount(0),
+    dumps(0),
+    stopping(false)
+{
+    if (budget > 0) {
+        writer = std::thread(&FlightRecorder::write, this);
+    }
+}
+
+FlightRecorder::~FlightRecorder() {
+    if (writer.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+
+        wake.notify_one();
+        writer.join();
+    }
+}
+
+double FlightRecorder::now() const {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void FlightRecorder::beginFrame() {
+    FrameRecord& record = frames[next];
+
+    record.frame = frameIndex;
+    record.start = now();
+    record.duration = 0;
+    record.deltaTime = 0;
+    record.wallContacts = 0;
+    record.sideContacts = 0;
+    record.cornerContacts = 0;
+    record.effect = NoEffect;
+
+    for (int phase = 0; phase < nPhases; phase++) {
+        record.phaseStart[phase] = record.start;
+        record.phaseDuration[phase] = 0;
+    }
+}
+
+void FlightRecorder::begin(Phase phase) {
+    frames[next].phaseStart[phase] = now();
+}
+
+void FlightRecorder::end(Phase phase) {
+    FrameRecord& record = frames[next];
+    record.phaseDuration[phase] = now() - record.phaseStart[phase];
+}
+
+void FlightRecorder::setDeltaTime(float deltaTime) {
+    frames[next].deltaTime = deltaTime;
+}
+
+void FlightRecorder::addContacts(const ContactList& contacts) {
+    FrameRecord& record = frames[next];
+
+    for (const auto& contact: contacts) {
+        if (contact.kind == WallContact) {
+            record.wallContacts++;
+        }
+        else if (contact.kind == SideContact) {
+            record.sideContacts++;
+        }
+        else {
+            record.cornerContacts++;
+        }
+    }
+}
+
+void FlightRecorder::setEffect(Effect effect) {
+    frames[next].effect = effect;
+}
+
+void FlightRecorder::endFrame() {
+    FrameRecord& record = frames[next];
+    record.duration = now() - record.start;
+
+    next = (next + 1) % frames.size();
+    if (count < frames.size()) {
+        count++;
+    }
+
+    frameIndex++;
+    sinceDump++;
+
+    // El primer cuadro incluye la creación del contexto y de las texturas
+    if (budget <= 0 || record.frame == 0 || record.duration <= budget || (dumps > 0 && sinceDump < frames.size())) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (pendingCount > 0) {
+        return;
+    }
+
+    // Del más antiguo al más reciente
+    std::size_t first = (next + frames.size() - count) % frames.size();
+
+    for (std::size_t i = 0; i < count; i++) {
+        pending[i] = frames[(first + i) % frames.size()];
+    }
+
+    pendingCount = count;
+    sinceDump = 0;
+    dumps++;
+    wake.notify_one();
+}
+
+unsigned long FlightRecorder::getDumps() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return dumps;
+}
+
+void FlightRecorder::write() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    for (;;) {
+        wake.wait(lock, [this]() { return pendingCount > 0 || stopping; });
+
+        // Un volcado pendiente se escribe aunque el programa esté cerrando
+        if (pendingCount == 0) {
+            break;
+        }
+
+        std::size_t n = pendingCount;
+        lock.unlock();
+
+        // El último cuadro de la copia es el que excedió el presupuesto
+        const FrameRecord& hitch = pending[n - 1];
+        char path[1024];
+        std::snprintf(path, sizeof(path), "%s-%lu.json", prefix.c_str(), hitch.frame);
+
+        if (writeTrace(path, &pending[0], n)) {
+            std::cerr << "Frame " << hitch.frame << " took " << hitch.duration/1000.0
+                      << " ms, last " << n << " frames written to \"" << path << "\"" << std::endl;
+        }
+        else {
+            std::cerr << "Failed to write \"" << path << "\"" << std::endl;
+        }
+
+        lock.lock();
+        pendingCount = 0;
+    }
+}
+
+bool FlightRecorder::writeTrace(const char* path, const FrameRecord* records, std::size_t n) const {
+    std::FILE* file = std::fopen(path, "w");
+
+    if (file == NULL) {
+        return false;
+    }
+
+    std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    std::fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"main loop\"}}");
+
+    // Un evento por cuadro con sus datos y uno anidado por cada fase
+    for (std::size_t i = 0; i < n; i++) {
+        const FrameRecord& record = records[i];
+
+        std::fprintf(file, ",\n{\"name\":\"frame\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f,"
+                     "\"args\":{\"frame\":%lu,\"dt\":%g,\"wall\":%u,\"side\":%u,\"corner\":%u,\"effect\":\"%s\"}}",
+                     record.start, record.duration, record.frame, static_cast<double>(record.deltaTime),
+                     record.wallContacts, record.sideContacts, record.cornerContacts, effectNames[1 + record.effect]);
+
+        for (int phase = 0; phase < nPhases; phase++) {
+            std::fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"phase\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+                         getPhaseName(static_cast<Phase>(phase)), record.phaseStart[phase], record.phaseDuration[phase]);
+        }
+    }
+
+    // Marca en el cuadro que excedió el presupuesto
+    const FrameRecord& hitch = records[n - 1];
+    std::fprintf(file, ",\n{\"name\":\"hitch\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"args\":{\"budget_ms\":%g,\"frame_ms\":%g}}",
+                 hitch.start + hitch.duration, budget/1000.0, hitch.duration/1000.0);
+    std::fprintf(file, "\n]}\n");
+
+    bool written = !std::ferror(file);
+    return (std::fclose(file) == 0) && written;
+}
@@ -0,0 +1,128 @@
+//****************************************************************************80
+//
+//  PROGRAM    :
+//               GeoT
+//
+//  PURPOSE    :
+//               Program to show Goemetric Transformations as an applied
+//               exploration SFML multimedia library.
+//
+//  PROGRAMMER :
+//               Martín Josemaría <martin.vuelta@gmail.com>
+//
+//               * Software Development and Research
+//                 SoftButterfly
+//                 Lima - Peru
+//
+//               * Faculty of Physical Science
+//                 Universidad Nacional Mayor de San Marcos
+//                 Lima - Peru
+//
+//  FILE       :
+//               flight.hpp
+//
+//  DESCRIPTION:
+//               Always-on flight recorder of the last frames of the main loop
+//               that dumps them as a Chrome trace when a frame is too slow.
+//
+//****************************************************************************80
+
+#ifndef GEOT_FLIGHT_HPP
+#define GEOT_FLIGHT_HPP
+
+#include "latency.hpp"
+#include "perf.hpp"
+#include "simulation.hpp"
+
+#include <cstddef>
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+//----------------------------------------------------------------------------80
+//  TIPOS
+//----------------------------------------------------------------------------80
+// Lo que se sabe de un cuadro del bucle principal. Los tiempos están en
+// microsegundos desde que se creó el registrador, como los usa el formato de
+// trazas de Chrome.
+struct FrameRecord {
+    unsigned long frame;
+    double start;
+    double duration;
+    double phaseStart[nPhases];
+    double phaseDuration[nPhases];
+    float deltaTime;
+    unsigned int wallContacts;
+    unsigned int sideContacts;
+    unsigned int cornerContacts;
+    Effect effect;
+};
+
+
+//----------------------------------------------------------------------------80
+//  REGISTRADOR DE VUELO
+//----------------------------------------------------------------------------80
+// Guarda siempre los últimos capacity cuadros en un anillo reservado al
+// construirse. Registrar un cuadro solo lee el reloj en los límites de cada
+// fase y copia unos números, sin asignaciones ni bloqueos.
+//
+// Cuando un cuadro tarda más que budget segundos el anillo se copia a un
+// segundo búfer y un hilo aparte lo escribe como prefix-<cuadro>.json, que se
+// abre en chrome://tracing o en Perfetto. Si ese hilo sigue escribiendo el
+// volcado anterior el nuevo se descarta, y después de un volcado no se hace
+// otro hasta que el anillo se haya renovado por completo. Con budget igual a
+// cero solo se registran los cuadros.
+class FlightRecorder {
+public:
+    FlightRecorder(std::size_t capacity, double budget, const std::string& prefix);
+    ~FlightRecorder();
+
+    void beginFrame();
+    void begin(Phase phase);
+    void end(Phase phase);
+
+    void setDeltaTime(float deltaTime);
+    void addContacts(const ContactList& contacts);
+    void setEffect(Effect effect);
+
+    // Cierra el cuadro actual y lo vuelca si excede el presupuesto. Un cuadro
+    // que empieza y no se cierra (en reposo) se descarta con el siguiente
+    // beginFrame.
+    void endFrame();
+
+    unsigned long getDumps() const;
+
+private:
+    FlightRecorder(const FlightRecorder&);
+    FlightRecorder& operator=(const FlightRecorder&);
+
+    double now() const;
+    void write();
+    bool writeTrace(const char* path, const FrameRecord* records, std::size_t n) const;
+
+    TimeStamp epoch;
+    double budget;
+    std::string prefix;
+
+    std::vector<FrameRecord> frames;
+    std::size_t next;
+    std::size_t count;
+    unsigned long frameIndex;
+    unsigned long sinceDump;
+
+    // Copia del anillo en orden cronológico que escribe el hilo
+    std::vector<FrameRecord> pending;
+    std::size_t pendingCount;
+    unsigned long dumps;
+    bool stopping;
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::thread writer;
+};
+
+#endif
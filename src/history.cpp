@@ -0,0 +1,492 @@
+//****************************************************************************80
+//
+//  PROGRAM    :
+//               GeoT
+//
+//  PURPOSE    :
+//               Program to show Goemetric Transformations as an applied
+//               exploration SFML multimedia library.
+//
+//  PROGRAMMER :
+//               Martín Josemaría <martin.vuelta@gmail.com>
+//
+//               * Software Development and Research
+//                 SoftButterfly
+//                 Lima - Peru
+//
+//               * Faculty of Physical Science
+//                 Universidad Nacional Mayor de San Marcos
+//                 Lima - Peru
+//
+//  FILE       :
+//               history.cpp
+//
+//  DESCRIPTION:
+//               Delta encoded snapshot history for rewinding the animation.
+//
+//****************************************************************************80
+
+#include "history.hpp"
+
+#include <cstring>
+
+#include <algorithm>
+
+
+// Una de cada keyframeInterval instantáneas se guarda completa
+static const std::size_t keyframeInterval = 16;
+
+// Parte del presupuesto para los datos de cada instantánea del anillo (el
+// resto es para sus palabras); una instantánea típica ocupa unos 500 bytes
+static const std::size_t bytesPerSnapshot = 512;
+
+
+//----------------------------------------------------------------------------80
+//  HISTORIAL
+//----------------------------------------------------------------------------80
+History::History(std::size_t budget, float seconds) :
+    interval(seconds),
+    ring(std::max<std::size_t>(2*keyframeInterval, budget/bytesPerSnapshot)),
+    first(0),
+    count(0),
+    pool(budget > ring.size()*sizeof(Snapshot) ? (budget - ring.size()*sizeof(Snapshot))/sizeof(std::uint32_t) : 0, 0),
+    head(0),
+    bytes(0),
+    end(0.f),
+    keyframe(0)
+{
+}
+
+History::Snapshot& History::at(std::size_t index) {
+    return ring[(first + index) % ring.size()];
+}
+
+const History::Snapshot& History::at(std::size_t index) const {
+    return ring[(first + index) % ring.size()];
+}
+
+std::size_t History::bytesOf(const Snapshot& snapshot) const {
+    return sizeof(Snapshot) + (snapshot.dataSize + snapshot.nSteps)*sizeof(std::uint32_t);
+}
+
+float History::getStep(const Snapshot& snapshot, std::size_t step) const {
+    float deltaTime;
+    std::memcpy(&deltaTime, &pool[snapshot.offset + snapshot.dataSize + step], sizeof(float));
+
+    return deltaTime;
+}
+
+void History::clear() {
+    first = 0;
+    count = 0;
+    head = 0;
+    bytes = 0;
+    end = 0.f;
+    keyframe = 0;
+}
+
+void History::record(const Simulation& simulation, float deltaTime) {
+    if (count == 0) {
+        capture(simulation);
+        return;
+    }
+
+    // Si el grupo actual ocupa todo el bloque se empieza de nuevo desde aquí
+    if (!makeRoom(1, true, false)) {
+        clear();
+        capture(simulation);
+        return;
+    }
+
+    Snapshot& last = at(count - 1);
+
+    std::memcpy(&pool[head], &deltaTime, sizeof(float));
+    head++;
+    last.nSteps++;
+    bytes += sizeof(float);
+    end = simulation.getElapsedTime();
+
+    if (end - last.time >= interval) {
+        capture(simulation);
+    }
+}
+
+void History::capture(const Simulation& simulation) {
+    simulation.saveState(state);
+
+    bool isKeyframe = count == 0 || count - keyframe >= keyframeInterval || state.size() != keyframeState.size();
+
+    // Sin lugar en el anillo ni en el bloque se descartan las instantáneas
+    // más antiguas. Una diferencia necesita conservar su instantánea
+    // completa; si no es posible, se empieza de nuevo con una completa.
+    if (count == ring.size() && !isKeyframe && keyframe == 0) {
+        isKeyframe = true;
+    }
+
+    while (count == ring.size()) {
+        dropOldest();
+    }
+
+    if (!makeRoom(state.size(), false, isKeyframe)) {
+        if (isKeyframe) {
+            clear();
+            return;
+        }
+
+        isKeyframe = true;
+
+        if (!makeRoom(state.size(), false, true)) {
+            clear();
+            return;
+        }
+    }
+
+    std::size_t index = count;
+    Snapshot& snapshot = at(index);
+
+    snapshot.time = simulation.getElapsedTime();
+    snapshot.offset = head;
+    snapshot.nSteps = 0;
+
+    // Si cambió casi todo (por ejemplo el generador de números al azar
+    // regeneró su estado) conviene más una instantánea completa
+    if (!isKeyframe) {
+        isKeyframe = !encode(state, &pool[head], state.size()/2, snapshot.dataSize);
+    }
+
+    if (isKeyframe) {
+        std::copy(state.begin(), state.end(), pool.begin() + static_cast<std::ptrdiff_t>(head));
+        snapshot.dataSize = state.size();
+        keyframeState = state;
+        keyframe = index;
+    }
+
+    snapshot.keyframe = isKeyframe;
+    count++;
+    head += snapshot.dataSize;
+    bytes += bytesOf(snapshot);
+    end = snapshot.time;
+}
+
+void History::truncate(const Simulation& simulation) {
+    float time = simulation.getElapsedTime();
+
+    while (count > 0 && at(count - 1).time >= time) {
+        bytes -= bytesOf(at(count - 1));
+        count--;
+    }
+
+    // También los pasos de la última instantánea posteriores a time
+    head = 0;
+
+    if (count > 0) {
+        Snapshot& last = at(count - 1);
+        std::size_t kept = countSteps(count - 1, time);
+
+        bytes -= (last.nSteps - kept)*sizeof(float);
+        last.nSteps = kept;
+        head = last.offset + last.dataSize + last.nSteps;
+    }
+
+    // La última instantánea completa que queda
+    keyframe = 0;
+
+    for (std::size_t i = count; i > 0; i--) {
+        if (at(i - 1).keyframe) {
+            const Snapshot& snapshot = at(i - 1);
+
+            keyframe = i - 1;
+            keyframeState.assign(pool.begin() + static_cast<std::ptrdiff_t>(snapshot.offset), pool.begin() + static_cast<std::ptrdiff_t>(snapshot.offset + snapshot.dataSize));
+            break;
+        }
+    }
+
+    capture(simulation);
+}
+
+bool History::seek(Simulation& simulation, float time) {
+    if (count == 0 || time < at(0).time) {
+        return false;
+    }
+
+    std::size_t index = locate(time);
+
+    return load(simulation, index, countSteps(index, time));
+}
+
+bool History::stepBy(Simulation& simulation, long frames) {
+    float time = simulation.getElapsedTime();
+
+    if (count == 0 || time < at(0).time) {
+        return false;
+    }
+
+    std::size_t index = locate(time);
+    std::size_t step = countSteps(index, time);
+
+    for (; frames > 0; frames--) {
+        if (step + 1 < getPositions(index)) {
+            step++;
+            continue;
+        }
+
+        // Primer paso de la siguiente instantánea con pasos
+        std::size_t next = index + 1;
+
+        while (next < count && getPositions(next) == 0) {
+            next++;
+        }
+
+        if (next == count) {
+            break;
+        }
+
+        index = next;
+        step = 0;
+    }
+
+    for (; frames < 0; frames++) {
+        if (step > 0) {
+            step--;
+            continue;
+        }
+
+        // Último paso de la instantánea anterior con pasos
+        std::size_t previous = index;
+
+        while (previous > 0 && getPositions(previous - 1) == 0) {
+            previous--;
+        }
+
+        if (previous == 0) {
+            break;
+        }
+
+        index = previous - 1;
+        step = getPositions(index) - 1;
+    }
+
+    return load(simulation, index, step);
+}
+
+std::size_t History::locate(float time) const {
+    std::size_t low = 0;
+    std::size_t high = count;
+
+    while (high - low > 1) {
+        std::size_t middle = (low + high)/2;
+
+        if (at(middle).time <= time) {
+            low = middle;
+        }
+        else {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+std::size_t History::countSteps(std::size_t index, float time) const {
+    // Se suman los pasos igual que en Simulation::step
+    const Snapshot& snapshot = at(index);
+    float elapsed = snapshot.time;
+    std::size_t steps = 0;
+
+    while (steps < snapshot.nSteps && elapsed + getStep(snapshot, steps) <= time) {
+        elapsed += getStep(snapshot, steps);
+        steps++;
+    }
+
+    return steps;
+}
+
+std::size_t History::getPositions(std::size_t index) const {
+    return at(index).nSteps + ((index + 1 == count) ? 1 : 0);
+}
+
+bool History::load(Simulation& simulation, std::size_t index, std::size_t steps) {
+    if (!decode(index, state) || !simulation.loadState(state.data(), state.size())) {
+        return false;
+    }
+
+    // Repetimos los pasos de la animación original
+    const Snapshot& snapshot = at(index);
+
+    for (std::size_t i = 0; i < steps && i < snapshot.nSteps; i++) {
+        simulation.step(getStep(snapshot, i));
+    }
+
+    return true;
+}
+
+// Deja words palabras libres a continuación de head. Si no caben antes del
+// final del bloque, la instantánea abierta (la última, si open) se mueve al
+// inicio. Se descartan los grupos más antiguos que haga falta: todos si se
+// empieza un grupo nuevo, si no todos menos el de la última completa.
+bool History::makeRoom(std::size_t words, bool open, bool newGroup) {
+    for (;;) {
+        std::size_t openOffset = open ? at(count - 1).offset : head;
+        std::size_t openWords = head - openOffset;
+        std::size_t others = open ? count - 1 : count;
+
+        if (others == 0) {
+            if (head + words <= pool.size()) {
+                return true;
+            }
+
+            if (openWords + words > pool.size()) {
+                return false;
+            }
+        }
+        else {
+            std::size_t tail = at(0).offset;
+
+            if (head > tail) {
+                if (head + words <= pool.size()) {
+                    return true;
+                }
+            }
+            else if (head + words <= tail) {
+                return true;
+            }
+
+            // Sin vuelta todavía, la instantánea abierta cabe al inicio
+            if (head <= tail || openWords + words > tail) {
+                if (newGroup ? others == 0 : keyframe == 0) {
+                    return false;
+                }
+
+                dropOldest();
+                continue;
+            }
+        }
+
+        // Vuelta al inicio del bloque
+        if (openWords > 0) {
+            std::copy(pool.begin() + static_cast<std::ptrdiff_t>(openOffset), pool.begin() + static_cast<std::ptrdiff_t>(head), pool.begin());
+        }
+
+        if (open) {
+            at(count - 1).offset = 0;
+        }
+
+        head = openWords;
+        return true;
+    }
+}
+
+// Diferencia con la última instantánea completa en output. Devuelve falso si
+// ocupa más de limit palabras.
+bool History::encode(const std::vector<std::uint32_t>& words, std::uint32_t* output, std::size_t limit, std::size_t& size) const {
+    std::size_t position = 0;
+    std::size_t length = words.size();
+
+    size = 0;
+
+    while (position < length) {
+        std::size_t begin = position;
+
+        while (begin < length && words[begin] == keyframeState[begin]) {
+            begin++;
+        }
+
+        if (begin == length) {
+            break;
+        }
+
+        std::size_t last = begin;
+
+        while (last < length && words[last] != keyframeState[last]) {
+            last++;
+        }
+
+        if (size + 2 + (last - begin) > limit) {
+            return false;
+        }
+
+        output[size++] = static_cast<std::uint32_t>(begin - position);
+        output[size++] = static_cast<std::uint32_t>(last - begin);
+        std::copy(words.begin() + static_cast<std::ptrdiff_t>(begin), words.begin() + static_cast<std::ptrdiff_t>(last), output + size);
+        size += last - begin;
+
+        position = last;
+    }
+
+    return true;
+}
+
+bool History::decode(std::size_t index, std::vector<std::uint32_t>& words) const {
+    std::size_t base = index;
+
+    while (!at(base).keyframe) {
+        if (base == 0) {
+            return false;
+        }
+
+        base--;
+    }
+
+    const std::uint32_t* keyframeData = &pool[at(base).offset];
+    words.assign(keyframeData, keyframeData + at(base).dataSize);
+
+    if (base == index) {
+        return true;
+    }
+
+    const std::uint32_t* data = &pool[at(index).offset];
+    std::size_t dataSize = at(index).dataSize;
+    std::size_t position = 0;
+
+    for (std::size_t i = 0; i + 1 < dataSize; ) {
+        position += data[i];
+        std::size_t n = data[i + 1];
+        i += 2;
+
+        if (position + n > words.size() || i + n > dataSize) {
+            return false;
+        }
+
+        std::copy(data + i, data + i + n, words.begin() + static_cast<std::ptrdiff_t>(position));
+        position += n;
+        i += n;
+    }
+
+    return true;
+}
+
+// Descarta el grupo más antiguo: su instantánea completa y las diferencias
+// que dependen de ella
+void History::dropOldest() {
+    do {
+        bytes -= bytesOf(at(0));
+
+        first = (first + 1) % ring.size();
+        count--;
+
+        if (keyframe > 0) {
+            keyframe--;
+        }
+    }
+    while (count > 0 && !at(0).keyframe);
+}
+
+bool History::isEmpty() const {
+    return count == 0;
+}
+
+float History::getBegin() const {
+    return count > 0 ? at(0).time : 0.f;
+}
+
+float History::getEnd() const {
+    return end;
+}
+
+std::size_t History::getSnapshotCount() const {
+    return count;
+}
+
+std::size_t History::getBytes() const {
+    return bytes;
+}
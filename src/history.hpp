@@ -0,0 +1,142 @@
+//****************************************************************************80
+//
+//  PROGRAM    :
+//               GeoT
+//
+//  PURPOSE    :
+//               Program to show Goemetric Transformations as an applied
+//               exploration SFML multimedia library.
+//
+//  PROGRAMMER :
+//               Martín Josemaría <martin.vuelta@gmail.com>
+//
+//               * Software Development and Research
+//                 SoftButterfly
+//                 Lima - Peru
+//
+//               * Faculty of Physical Science
+//                 Universidad Nacional Mayor de San Marcos
+//                 Lima - Peru
+//
+//  FILE       :
+//               history.hpp
+//
+//  DESCRIPTION:
+//               Bounded history of delta encoded simulation snapshots for
+//               rewinding and scrubbing the animation.
+//
+//****************************************************************************80
+
+#ifndef GEOT_HISTORY_HPP
+#define GEOT_HISTORY_HPP
+
+#include "simulation.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <vector>
+
+
+//----------------------------------------------------------------------------80
+//  HISTORIAL
+//----------------------------------------------------------------------------80
+// Cada interval segundos simulados se guarda una instantánea del estado de la
+// simulación junto con los pasos (deltaTime) dados desde entonces. Una de
+// cada keyframeInterval instantáneas se guarda completa y las demás solo con
+// las palabras que cambiaron respecto a esa instantánea completa. Para volver
+// a un instante se restaura la instantánea anterior más cercana y se repiten
+// sus pasos, así el resultado es idéntico al de la animación original.
+//
+// Toda la memoria (budget bytes) se reserva al construir el historial: las
+// instantáneas se escriben una detrás de otra en un bloque circular de
+// palabras y cuando no hay lugar se descartan las más antiguas (un grupo
+// completo a la vez). Registrar pasos y guardar instantáneas no asigna
+// memoria mientras el tamaño del estado no crezca.
+class History {
+public:
+    History(std::size_t budget, float interval);
+
+    void clear();
+
+    // Llamar después de cada paso de la simulación
+    void record(const Simulation& simulation, float deltaTime);
+
+    // Guarda una instantánea ahora, por ejemplo al iniciar o después de
+    // cambiar la simulación desde fuera (activar el efecto especial)
+    void capture(const Simulation& simulation);
+
+    // Descarta todo lo posterior al instante actual de la simulación, para
+    // continuar la animación después de retroceder
+    void truncate(const Simulation& simulation);
+
+    // Lleva la simulación al último paso registrado que no pasa de time.
+    // Devuelve falso si time es anterior al historial.
+    bool seek(Simulation& simulation, float time);
+
+    // Avanza (frames positivo) o retrocede frames pasos registrados desde el
+    // instante actual de la simulación, sin salir del historial. Devuelve
+    // falso si el instante actual es anterior al historial.
+    bool stepBy(Simulation& simulation, long frames);
+
+    bool isEmpty() const;
+    float getBegin() const;
+    float getEnd() const;
+
+    std::size_t getSnapshotCount() const;
+    std::size_t getBytes() const;
+
+private:
+    // Las palabras de una instantánea empiezan en offset dentro de pool:
+    // dataSize palabras de estado seguidas de nSteps pasos. Completa: el
+    // estado tal cual. Diferencia: grupos (salto, n) seguidos de n palabras
+    // que reemplazan a las de la instantánea completa.
+    struct Snapshot {
+        float time;
+        bool keyframe;
+        std::size_t offset;
+        std::size_t dataSize;
+        std::size_t nSteps;
+    };
+
+    Snapshot& at(std::size_t index);
+    const Snapshot& at(std::size_t index) const;
+    std::size_t bytesOf(const Snapshot& snapshot) const;
+    float getStep(const Snapshot& snapshot, std::size_t step) const;
+
+    // Última instantánea que no pasa de time y pasos suyos hasta time
+    std::size_t locate(float time) const;
+    std::size_t countSteps(std::size_t index, float time) const;
+
+    // Instantes que se pueden visitar dentro de una instantánea: sus pasos
+    // (el último paso de una instantánea lleva al inicio de la siguiente)
+    std::size_t getPositions(std::size_t index) const;
+    bool load(Simulation& simulation, std::size_t index, std::size_t steps);
+
+    bool makeRoom(std::size_t words, bool open, bool newGroup);
+    bool encode(const std::vector<std::uint32_t>& words, std::uint32_t* output, std::size_t limit, std::size_t& size) const;
+    bool decode(std::size_t index, std::vector<std::uint32_t>& words) const;
+    void dropOldest();
+
+    float interval;
+
+    std::vector<Snapshot> ring;
+    std::size_t first;
+    std::size_t count;
+
+    // Palabras de las instantáneas, head es el final de la última
+    std::vector<std::uint32_t> pool;
+    std::size_t head;
+
+    std::size_t bytes;
+    float end;
+
+    // Última instantánea completa y el estado que guarda
+    std::size_t keyframe;
+    std::vector<std::uint32_t> keyframeState;
+
+    // Memoria de trabajo para no asignar en cada instantánea
+    std::vector<std::uint32_t> state;
+};
+
+#endif
@@ -0,0 +1,161 @@
+//****************************************************************************80
+//
+//  PROGRAM    :
+//               GeoT
+//
+//  PURPOSE    :
+//               Program to show Goemetric Transformations as an applied
+//               exploration SFML multimedia library.
+//
+//  PROGRAMMER :
+//               Martín Josemaría <martin.vuelta@gmail.com>
+//
+//               * Software Development and Research
+//                 SoftButterfly
+//                 Lima - Peru
+//
+//               * Faculty of Physical Science
+//                 Universidad Nacional Mayor de San Marcos
+//                 Lima - Peru
+//
+//  FILE       :
+//               latency.cpp
+//
+//  DESCRIPTION:
+//               Input to display latency samples and percentiles, and the
+//               frame pacing used to read input late.
+//
+//****************************************************************************80
+
+#include "latency.hpp"
+
+#include <iomanip>
+#include <algorithm>
+
+
+// Holgura de la lectura tardía para la imprecisión de sleep_until y las
+// variaciones del tiempo de preparación
+static const double latchMargin = 0.002;
+
+
+// Percentil por rango más cercano sobre una copia ordenada
+static double percentile(std::vector<double> samples, double p) {
+    if (samples.empty()) {
+        return 0.0;
+    }
+
+    std::size_t rank = static_cast<std::size_t>(p / 100.0 * static_cast<double>(samples.size() - 1) + 0.5);
+    std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(rank), samples.end());
+
+    return samples[rank];
+}
+
+
+//----------------------------------------------------------------------------80
+//  LATENCIA
+//----------------------------------------------------------------------------80
+LatencyRecorder::LatencyRecorder(std::size_t capacity) :
+    toSimulate(capacity, 0.0),
+    toPresent(capacity, 0.0),
+    queuedToPresent(capacity, 0.0),
+    next(0),
+    count(0)
+{
+}
+
+void LatencyRecorder::add(const InputStamp& input, TimeStamp presented) {
+    if (toPresent.empty()) {
+        return;
+    }
+
+    toSimulate[next] = std::chrono::duration<double, std::milli>(input.simulated - input.received).count();
+    toPresent[next] = std::chrono::duration<double, std::milli>(presented - input.received).count();
+    queuedToPresent[next] = std::chrono::duration<double, std::milli>(presented - input.queued).count();
+
+    next = (next + 1) % toPresent.size();
+    count = std::min(count + 1, toPresent.size());
+}
+
+std::size_t LatencyRecorder::getCount() const {
+    return count;
+}
+
+void LatencyRecorder::print(std::ostream& output) const {
+    std::vector<double> simulate(toSimulate.begin(), toSimulate.begin() + static_cast<std::ptrdiff_t>(count));
+    std::vector<double> present(toPresent.begin(), toPresent.begin() + static_cast<std::ptrdiff_t>(count));
+    std::vector<double> queued(queuedToPresent.begin(), queuedToPresent.begin() + static_cast<std::ptrdiff_t>(count));
+    const double percentiles[] = {50.0, 90.0, 99.0, 100.0};
+    const char* names[] = {"p50", "p90", "p99", "max"};
+
+    output << "inputs: " << count << std::endl;
+    output << "read: event dequeued (lower bound), queued: previous queue drain (upper bound)" << std::endl;
+    output << std::setw(20) << "latency (ms)";
+    for (const char* name: names) {
+        output << std::setw(10) << name;
+    }
+    output << std::endl;
+
+    output << std::setw(20) << "read -> simulate";
+    for (double p: percentiles) {
+        output << std::setw(10) << percentile(simulate, p);
+    }
+    output << std::endl;
+
+    output << std::setw(20) << "read -> present";
+    for (double p: percentiles) {
+        output << std::setw(10) << percentile(present, p);
+    }
+    output << std::endl;
+
+    output << std::setw(20) << "queued -> present";
+    for (double p: percentiles) {
+        output << std::setw(10) << percentile(queued, p);
+    }
+    output << std::endl;
+}
+
+
+//----------------------------------------------------------------------------80
+//  LECTURA TARDÍA
+//----------------------------------------------------------------------------80
+FramePacer::FramePacer() :
+    nIntervals(0),
+    nPrepares(0),
+    hasPresent(false)
+{
+    for (int i = 0; i < nSamples; i++) {
+        intervals[i] = 0.0;
+        prepares[i] = 0.0;
+    }
+}
+
+void FramePacer::addPresent(TimeStamp presented) {
+    if (hasPresent) {
+        intervals[nIntervals % nSamples] = std::chrono::duration<double>(presented - lastPresent).count();
+        nIntervals++;
+    }
+
+    lastPresent = presented;
+    hasPresent = true;
+}
+
+void FramePacer::addPrepare(double seconds) {
+    prepares[nPrepares % nSamples] = seconds;
+    nPrepares++;
+}
+
+TimeStamp FramePacer::getLatchTime() const {
+    if (nIntervals == 0 || nPrepares == 0) {
+        return lastPresent;
+    }
+
+    double interval = *std::min_element(intervals, intervals + std::min<std::size_t>(nIntervals, nSamples));
+    double prepare = *std::max_element(prepares, prepares + std::min<std::size_t>(nPrepares, nSamples));
+    double wait = interval - prepare - latchMargin;
+
+    if (wait <= 0.0) {
+        return lastPresent;
+    }
+
+    return lastPresent + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(wait));
+}
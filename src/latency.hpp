@@ -0,0 +1,116 @@
+//****************************************************************************80
+//
+//  PROGRAM    :
+//               GeoT
+//
+//  PURPOSE    :
+//               Program to show Goemetric Transformations as an applied
+//               exploration SFML multimedia library.
+//
+//  PROGRAMMER :
+//               Martín Josemaría <martin.vuelta@gmail.com>
+//
+//               * Software Development and Research
+//                 SoftButterfly
+//                 Lima - Peru
+//
+//               * Faculty of Physical Science
+//                 Universidad Nacional Mayor de San Marcos
+//                 Lima - Peru
+//
+//  FILE       :
+//               latency.hpp
+//
+//  DESCRIPTION:
+//               Input to display latency samples and percentiles, and the
+//               frame pacing used to read input late.
+//
+//****************************************************************************80
+
+#ifndef GEOT_LATENCY_HPP
+#define GEOT_LATENCY_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+
+//----------------------------------------------------------------------------80
+//  TIPOS
+//----------------------------------------------------------------------------80
+typedef std::chrono::steady_clock::time_point TimeStamp;
+
+// Entrada que cambió el estado de la animación, con el instante en que se
+// leyó de la cola de eventos y el instante en que la simulación la consumió.
+// SFML no marca la hora de los eventos: la entrada llegó en algún momento
+// entre la última vez que se vació la cola (queued) y received.
+struct InputStamp {
+    TimeStamp queued;
+    TimeStamp received;
+    TimeStamp simulated;
+};
+
+
+//----------------------------------------------------------------------------80
+//  LATENCIA
+//----------------------------------------------------------------------------80
+// Guarda las últimas capacity muestras (en un anillo, sin asignaciones
+// después de construirse) y reporta sus percentiles. Medida desde received
+// la latencia es una cota inferior, medida desde queued una cota superior.
+class LatencyRecorder {
+public:
+    explicit LatencyRecorder(std::size_t capacity);
+
+    // Agrega una entrada que acaba de mostrarse en pantalla
+    void add(const InputStamp& input, TimeStamp presented);
+
+    std::size_t getCount() const;
+
+    void print(std::ostream& output) const;
+
+private:
+    std::vector<double> toSimulate;
+    std::vector<double> toPresent;
+    std::vector<double> queuedToPresent;
+    std::size_t next;
+    std::size_t count;
+};
+
+
+//----------------------------------------------------------------------------80
+//  LECTURA TARDÍA
+//----------------------------------------------------------------------------80
+// Predice la siguiente sincronización vertical a partir de los instantes en
+// que display() devuelve el control, y el tiempo que toma preparar un cuadro
+// (leer eventos, simular y dibujar), para leer las entradas lo más tarde
+// posible sin perder la sincronización. El intervalo es el mínimo de las
+// últimas presentaciones (un cuadro perdido o una pausa no lo alargan) y el
+// tiempo de preparación el máximo de los últimos cuadros.
+class FramePacer {
+public:
+    FramePacer();
+
+    void addPresent(TimeStamp presented);
+    void addPrepare(double seconds);
+
+    // Instante en que conviene empezar a preparar el siguiente cuadro. Sin
+    // muestras suficientes, o si preparar el cuadro toma todo el intervalo,
+    // es el de la última presentación (no hay que esperar).
+    TimeStamp getLatchTime() const;
+
+private:
+    enum {
+        nSamples = 32
+    };
+
+    double intervals[nSamples];
+    double prepares[nSamples];
+    std::size_t nIntervals;
+    std::size_t nPrepares;
+
+    TimeStamp lastPresent;
+    bool hasPresent;
+};
+
+#endif
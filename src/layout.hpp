@@ -0,0 +1,72 @@
+//****************************************************************************80
+//
+//  PROGRAM    :
+//               GeoT
+//
+//  PURPOSE    :
+//               Program to show Goemetric Transformations as an applied
+//               exploration SFML multimedia library.
+//
+//  PROGRAMMER :
+//               Martín Josemaría <martin.vuelta@gmail.com>
+//
+//               * Software Development and Research
+//                 SoftButterfly
+//                 Lima - Peru
+//
+//               * Faculty of Physical Science
+//                 Universidad Nacional Mayor de San Marcos
+//                 Lima - Peru
+//
+//  FILE       :
+//               layout.hpp
+//
+//  DESCRIPTION:
+//               Geometry of the obstacles: bounds precomputed once per
+//               scene and the obstacle count of the built in scene.
+//
+//****************************************************************************80
+
+#ifndef GEOT_LAYOUT_HPP
+#define GEOT_LAYOUT_HPP
+
+#include <cstddef>
+
+
+//----------------------------------------------------------------------------80
+//  TIPOS
+//----------------------------------------------------------------------------80
+// Obstáculo alineado a los ejes: lados, centro y mitad del tamaño. Dependen
+// del tamaño de los obstáculos de la escena, así que Simulation los calcula al
+// cargar la escena y cuando los obstáculos se mueven, no en cada choque a
+// partir del centro y obstacleSize/2.
+struct ObstacleBounds {
+    float left;
+    float right;
+    float top;
+    float bottom;
+    float centerX;
+    float centerY;
+    float halfWidth;
+    float halfHeight;
+};
+
+
+//----------------------------------------------------------------------------80
+//  GEOMETRÍA
+//----------------------------------------------------------------------------80
+// Se usan las mismas operaciones que en el bucle de choques original para
+// que los resultados no cambien en el último bit
+inline ObstacleBounds makeBounds(float x, float y, float width, float height) {
+    return ObstacleBounds{x - width/2, x + width/2, y - height/2, y + height/2, x, y, width/2.f, height/2.f};
+}
+
+
+//----------------------------------------------------------------------------80
+//  ESCENA POR DEFECTO
+//----------------------------------------------------------------------------80
+// Cuatro obstáculos en los tercios del panel: Simulation usa con ellos la
+// versión de collide con el número de obstáculos fijo
+const std::size_t defaultObstacleCount = 4;
+
+#endif
@@ -30,11 +30,28 @@
 #include <SFML/Config.hpp>
 #include <SFML/Graphics.hpp>
 
+#include "batch.hpp"
+#include "flight.hpp"
+#include "history.hpp"
+#include "latency.hpp"
+#include "memory.hpp"
+#include "painter.hpp"
+#include "perf.hpp"
+#include "raster.hpp"
+#include "scene.hpp"
+#include "simulation.hpp"
+
 #include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 #include <array>
+#include <algorithm>
 #include <string>
+#include <vector>
 #include <random>
+#include <thread>
 #include <iostream>
 
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__TOS_WIN__)
@@ -57,7 +74,7 @@ std::string getExecutablePath();
 //----------------------------------------------------------------------------80
 //  FUNCION PRINCIPAL (MAIN)
 //----------------------------------------------------------------------------80
-int main() {
+int main(int argc, char* argv[]) {
 
     //------------------------------------------------------------------------80
     //  CONSTANTES
@@ -69,8 +86,7 @@ int main() {
     const sf::Color PinkA2(255, 64, 129, 255);
     const sf::Color Red(244,67,54);
 
-    // PI, para poder medir los angulos de direccion de movimiento de la
-    // pelota usando radianes en fracciones de pi.
+    // PI, para mostrar los angulos de los impactos en grados
     const float pi = 3.14159265358979f;
 
     // Tamaño de la ventana de la aplciación
@@ -87,33 +103,333 @@ int main() {
     const float separatorWidth = 2.f;
     // const float borderWidth = 2.f;
 
-    // Número de obstaculos
-    // Se usaran 4 obstaculos en posiciones fijas. Este valor se asigna en una
-    // constante durante todo el programa, si cambia su valor aquí introducirá
-    // errores pues siempre se asume que su valor es 4.
-    const int nObstacles = 4;
+    // Origen del panel de juego, las posiciones de la escena son relativas a
+    // este punto
+    const sf::Vector2f fieldOrigin(0.f, windowHeight - panelHeight);
 
-    // Tamaño de los obstaculos 60x60
-    const sf::Vector2f obstacleSize(60, 60);
+    // Medidas y colores con que se dibuja la escena, en la ventana y por
+    // software
+    SceneStyle sceneStyle;
+    sceneStyle.windowSize = sf::Vector2f(windowWidth, windowHeight);
+    sceneStyle.panelSize = sf::Vector2f(panelWidth, panelHeight);
+    sceneStyle.separatorWidth = separatorWidth;
+    sceneStyle.background = GreyD4;
+    sceneStyle.foreground = GreyL4;
+    sceneStyle.highlight = Red;
 
-    // Radio de la pelota
-    const float ballRadius = 20.f;
+    //------------------------------------------------------------------------80
+    // ESCENA
+    //------------------------------------------------------------------------80
+    // Por defecto se usan 4 obstaculos en posiciones fijas. Con la opción
+    // --scene se carga otra escena (texto o binaria) y se recarga en caliente
+    // cada vez que el archivo cambia. Con --compile-scene se convierte una
+    // escena de texto al formato binario.
+    //
+    // Con --batch N se ejecutan N simulaciones sin ventana en todos los
+    // núcleos y se imprimen los histogramas resultantes.
+    //
+    // Con --headless N se simulan N cuadros sin ventana y con --benchmark N
+    // se dibujan N cuadros sin sincronización vertical; ambos imprimen los
+    // tiempos y contadores del procesador de cada fase del bucle (por cuadro
+    // con --per-frame).
+    Scene scene;
+    SceneWatcher sceneWatcher;
+    std::string scenePath = "";
+
+    // Con --frame-stats se imprime cada segundo el uso de memoria por cuadro
+    bool frameStats = false;
+
+    unsigned long headlessFrames = 0;
+    unsigned long benchmarkFrames = 0;
+    bool perFrame = false;
+
+    // Con --latency se reportan al salir los percentiles de la latencia desde
+    // que se lee una tecla hasta que el cambio se muestra. Con --late-latch
+    // los eventos se leen poco antes de la siguiente sincronización vertical.
+    bool reportLatency = false;
+    bool lateLatch = false;
+
+    // Memoria para el historial que permite retroceder durante la pausa
+    unsigned long historyMegabytes = 4;
+
+    // Un cuadro que tarda más de hitchBudget milisegundos vuelca los últimos
+    // cuadros en hitchPrefix-<cuadro>.json (0 desactiva los volcados)
+    double hitchBudget = 50;
+    std::string hitchPrefix = "hitch";
+
+    // Dibujo por software, sin OpenGL: imagen del último cuadro (--render),
+    // todos los cuadros (--export) o comparación con una imagen de
+    // referencia (--golden)
+    unsigned long renderFrames = 0;
+    std::string renderPath;
+    std::string exportDirectory;
+    std::string goldenPath;
+
+    BatchSettings batchSettings;
+    batchSettings.runs = 0;
+    batchSettings.duration = 60.f;
+    batchSettings.deltaTime = 1.f/60.f;
+    batchSettings.seed = 0;
+    batchSettings.threads = 0;
+    batchSettings.specialEffect = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--scene") == 0 && i + 1 < argc) {
+            scenePath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batchSettings.runs = std::strtoul(argv[++i], NULL, 10);
+        }
+        else if (std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            batchSettings.duration = std::strtof(argv[++i], NULL);
+        }
+        else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            batchSettings.seed = static_cast<unsigned int>(std::strtoul(argv[++i], NULL, 10));
+        }
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            batchSettings.threads = static_cast<unsigned int>(std::strtoul(argv[++i], NULL, 10));
+        }
+        else if (std::strcmp(argv[i], "--effect") == 0) {
+            batchSettings.specialEffect = true;
+        }
+        else if (std::strcmp(argv[i], "--frame-stats") == 0) {
+            frameStats = true;
+        }
+        else if (std::strcmp(argv[i], "--headless") == 0 && i + 1 < argc) {
+            headlessFrames = std::strtoul(argv[++i], NULL, 10);
+        }
+        else if (std::strcmp(argv[i], "--benchmark") == 0 && i + 1 < argc) {
+            benchmarkFrames = std::strtoul(argv[++i], NULL, 10);
+        }
+        else if (std::strcmp(argv[i], "--per-frame") == 0) {
+            perFrame = true;
+        }
+        else if (std::strcmp(argv[i], "--latency") == 0) {
+            reportLatency = true;
+        }
+        else if (std::strcmp(argv[i], "--late-latch") == 0) {
+            lateLatch = true;
+        }
+        else if (std::strcmp(argv[i], "--history-mb") == 0 && i + 1 < argc) {
+            historyMegabytes = std::strtoul(argv[++i], NULL, 10);
+        }
+        else if (std::strcmp(argv[i], "--hitch-budget") == 0 && i + 1 < argc) {
+            hitchBudget = std::strtod(argv[++i], NULL);
+        }
+        else if (std::strcmp(argv[i], "--hitch-prefix") == 0 && i + 1 < argc) {
+            hitchPrefix = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--render") == 0 && i + 2 < argc) {
+            renderFrames = std::strtoul(argv[++i], NULL, 10);
+            renderPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--export") == 0 && i + 2 < argc) {
+            renderFrames = std::strtoul(argv[++i], NULL, 10);
+            exportDirectory = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--golden") == 0 && i + 2 < argc) {
+            renderFrames = std::strtoul(argv[++i], NULL, 10);
+            goldenPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--compile-scene") == 0 && i + 2 < argc) {
+            Scene compiled;
+            if (!compiled.loadFromFile(argv[i + 1]) || !compiled.saveToBinary(argv[i + 2])) {
+                return EXIT_FAILURE;
+            }
+            return EXIT_SUCCESS;
+        }
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--scene file] [--frame-stats] [--latency] [--late-latch] [--history-mb n] [--hitch-budget ms] [--hitch-prefix path] [--compile-scene text binary]" << std::endl;
+            std::cerr << "       " << argv[0] << " --batch runs [--seconds s] [--seed n] [--threads n] [--effect] [--scene file]" << std::endl;
+            std::cerr << "       " << argv[0] << " --headless frames|--benchmark frames [--per-frame] [--seed n] [--effect] [--scene file]" << std::endl;
+            std::cerr << "       " << argv[0] << " --render frames image|--export frames directory|--golden frames image [--threads n] [--seed n] [--effect] [--scene file]" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (scenePath.empty()) {
+        std::vector<sf::Vector2f> defaultObstacles;
+        defaultObstacles.push_back(sf::Vector2f(panelWidth/3.f, panelHeight/3.f));
+        defaultObstacles.push_back(sf::Vector2f(panelWidth/3.f, 2*panelHeight/3.f));
+        defaultObstacles.push_back(sf::Vector2f(2*panelWidth/3.f, panelHeight/3.f));
+        defaultObstacles.push_back(sf::Vector2f(2*panelWidth/3.f, 2*panelHeight/3.f));
+        scene.setObstacles(defaultObstacles);
+    }
+    else {
+        if (!scene.loadFromFile(scenePath)) {
+            return EXIT_FAILURE;
+        }
+        sceneWatcher.watch(scenePath);
+    }
 
-    // Rapides de la pelota
-    const float ballSpeed = 150.f;
+    // Modo por lotes (sin ventana)
+    if (batchSettings.runs > 0) {
+        BatchResult result = runBatch(scene, fieldOrigin, sf::Vector2f(panelWidth, panelHeight), batchSettings);
+        printBatchResult(std::cout, result);
+        return EXIT_SUCCESS;
+    }
 
     //------------------------------------------------------------------------80
     // VARIABLES UTILES
     //------------------------------------------------------------------------80
-    // Tiempo acumulado para el efecto especial
-    float time = 0.f;
+    // Semilla para el angulo inicial, los obstáculos y la selecion de eventos
+    std::random_device seedDevice;
+
+    // Movimiento de la pelota y los obstáculos
+    Simulation simulation(scene, fieldOrigin, sf::Vector2f(panelWidth, panelHeight), seedDevice());
+
+    // Memoria para las listas que solo duran un cuadro (choques y entradas),
+    // se reinicia en cada vuelta del bucle principal
+    FrameArena frameArena(1024*1024);
+
+    // Instantáneas de la simulación cada cuarto de segundo para retroceder y
+    // avanzar durante la pausa (flechas izquierda y derecha)
+    History history(historyMegabytes*1024*1024, 0.25f);
+
+    // Tiempos y contadores por fase del bucle (--headless y --benchmark)
+    PerfCounters perfCounters;
+
+    if (headlessFrames > 0 || benchmarkFrames > 0 || renderFrames > 0) {
+        perfCounters.enable();
+    }
+
+    // Modo sin ventana: solo la física, con paso de tiempo fijo
+    if (headlessFrames > 0) {
+        Simulation headless(scene, fieldOrigin, sf::Vector2f(panelWidth, panelHeight), batchSettings.seed);
+        headless.setSpecialEffect(batchSettings.specialEffect);
+        headless.start();
+
+        for (unsigned long frame = 0; frame < headlessFrames; frame++) {
+            frameArena.reset();
+            ContactList contacts((ArenaAllocator<Contact>(frameArena)));
+
+            perfCounters.begin(PhysicsPhase);
+            headless.step(batchSettings.deltaTime, &contacts);
+            perfCounters.end(PhysicsPhase);
+
+            if (perFrame) {
+                perfCounters.printFrame(std::cout, frame == 0);
+            }
+
+            perfCounters.endFrame();
+        }
+
+        perfCounters.printTotals(std::cout);
+        return EXIT_SUCCESS;
+    }
+
+    // Dibujo por software: la misma escena que en la ventana pero dibujada en
+    // memoria, con paso de tiempo fijo. No necesita OpenGL (servidores sin
+    // GPU) y las imágenes son idénticas pixel a pixel con la misma semilla.
+    if (renderFrames > 0) {
+        std::string resourcesPath = getExecutablePath();
+
+        if (resourcesPath.length() > 0) {
+            resourcesPath += PATHSEP;
+        }
 
-    // Dirección de la pelota
-    float ballAngle = 0.f;
+        resourcesPath += "resources" + PATHSEP;
+
+        // Texturas como imágenes en memoria (sf::Texture necesita OpenGL)
+        sf::Image ballImage;
+        sf::Image brickImage;
+        sf::Image flagImage;
+        sf::Image grassImage;
+        GlyphFont glyphFont;
+
+        if (!ballImage.loadFromFile(resourcesPath + "sphere.png") ||
+            !brickImage.loadFromFile(resourcesPath + "brick.png") ||
+            !flagImage.loadFromFile(resourcesPath + "pe.png") ||
+            !grassImage.loadFromFile(resourcesPath + "grass.png") ||
+            !glyphFont.loadFromFile(resourcesPath + "sansation.ttf")) {
+            return EXIT_FAILURE;
+        }
+
+        Simulation rendered(scene, fieldOrigin, sf::Vector2f(panelWidth, panelHeight), batchSettings.seed);
+        rendered.setSpecialEffect(batchSettings.specialEffect);
+        rendered.start();
+
+        Rasterizer rasterizer(static_cast<unsigned int>(windowWidth), static_cast<unsigned int>(windowHeight), batchSettings.threads);
+        RasterCanvas canvas(rasterizer, sceneStyle, glyphFont, ballImage, brickImage, flagImage, grassImage);
+        sf::Image frameImage;
+
+        // Estado de las animaciones, se actualiza igual que en la ventana
+        EffectAnimation animation;
+        animation.reset(NoEffect, rendered.getBallRadius());
+
+        for (unsigned long frame = 0; frame < renderFrames; frame++) {
+            if (rendered.step(batchSettings.deltaTime)) {
+                animation.reset(rendered.getEffect(), rendered.getBallRadius());
+            }
+
+            animation.advance(rendered.getBall(0).position);
+
+            // Solo se dibujan los cuadros que se guardan
+            if (exportDirectory.empty() && frame + 1 < renderFrames) {
+                continue;
+            }
+
+            perfCounters.begin(DrawPhase);
+
+            paintScene(canvas, sceneStyle, rendered, animation, true);
+            rasterizer.flush();
+
+            perfCounters.end(DrawPhase);
+            perfCounters.endFrame();
+
+            if (!exportDirectory.empty()) {
+                char name[32];
+                std::snprintf(name, sizeof(name), "frame%05lu.png", frame);
 
-    // Greneradores aleatorios para el angiulo inicial y la selecion de eventos
-    std::random_device angleDistribution;
-    std::random_device effectDistribution;
+                rasterizer.copyToImage(frameImage);
+
+                if (!frameImage.saveToFile(exportDirectory + PATHSEP + name)) {
+                    return EXIT_FAILURE;
+                }
+            }
+        }
+
+        perfCounters.printTotals(std::cout);
+        rasterizer.copyToImage(frameImage);
+
+        if (!renderPath.empty() && !frameImage.saveToFile(renderPath)) {
+            return EXIT_FAILURE;
+        }
+
+        // Comparación exacta con la imagen de referencia, si no coincide se
+        // guarda la imagen obtenida junto a la referencia
+        if (!goldenPath.empty()) {
+            sf::Image reference;
+
+            if (!reference.loadFromFile(goldenPath)) {
+                return EXIT_FAILURE;
+            }
+
+            unsigned long different = 0;
+            std::size_t nPixels = static_cast<std::size_t>(rasterizer.getWidth())*rasterizer.getHeight();
+
+            if (reference.getSize() != sf::Vector2u(rasterizer.getWidth(), rasterizer.getHeight())) {
+                different = nPixels;
+            }
+            else {
+                for (std::size_t i = 0; i < nPixels; i++) {
+                    if (std::memcmp(reference.getPixelsPtr() + 4*i, rasterizer.getPixels() + 4*i, 4) != 0) {
+                        different++;
+                    }
+                }
+            }
+
+            if (different > 0) {
+                std::cerr << "Golden image mismatch: " << different << " pixels differ from \"" << goldenPath << "\"" << std::endl;
+                frameImage.saveToFile(goldenPath + ".actual.png");
+                return EXIT_FAILURE;
+            }
+
+            std::cout << "golden image matches \"" << goldenPath << "\"" << std::endl;
+        }
+
+        return EXIT_SUCCESS;
+    }
 
     //------------------------------------------------------------------------80
     // VEWNTANA DE LA APLICACIÓN
@@ -131,8 +447,9 @@ int main() {
         sf::Style::Titlebar | sf::Style::Close, settings
     );
 
-    // Para "mejorar" la fecuencia de actualización de la pantalla
-    window.setVerticalSyncEnabled(true);
+    // Para "mejorar" la fecuencia de actualización de la pantalla (en el
+    // modo --benchmark se dibuja tan rápido como se pueda)
+    window.setVerticalSyncEnabled(benchmarkFrames == 0);
 
     //------------------------------------------------------------------------80
     // RECURSOS EXTERNOS
@@ -232,92 +549,21 @@ int main() {
     welcomeMessage[6].setPosition(100, 350);
     welcomeMessage[6].setString(L"Porque yo creo en ti ¡Vamos Perú!");
 
-    // Mensaje de animaciones en el banner (parte superior por encima de los
-    // paneles)
-    std::array<sf::Text, 2> banner;
+    // Precarga de los caracteres del mensaje de bienvenida
+    std::vector<const sf::Text*> welcomeTexts;
 
-    for (auto& coordinate: banner) {
-        coordinate.setFont(fontSansation);
-        coordinate.setCharacterSize(30);
-        coordinate.setFillColor(GreyL4);
+    for (const auto& message: welcomeMessage) {
+        welcomeTexts.push_back(&message);
     }
 
-    banner[0].setString(L"Animación activa: ");
-    banner[0].setPosition(10, 0.5f*(windowHeight - panelHeight - banner[0].getLocalBounds().height));
-
-    banner[1].setString(L"Traslación");
-    banner[1].setCharacterSize(30);
-    banner[1].setPosition(30 + banner[0].getLocalBounds().left + banner[0].getLocalBounds().width, 0.5f*(windowHeight - panelHeight - banner[1].getLocalBounds().height));
-    banner[1].setStyle(sf::Text::Bold);
-    banner[1].setFillColor(Red);
-
-    // Separadores de los paneles
-    sf::RectangleShape topSeparator;
-    topSeparator.setSize(sf::Vector2f(windowWidth, separatorWidth));
-    topSeparator.setFillColor(GreyD4);
-    topSeparator.setPosition(0, windowHeight - panelHeight - separatorWidth);
-
-    sf::RectangleShape verticalSeparator;
-    verticalSeparator.setSize(sf::Vector2f(separatorWidth, panelHeight));
-    verticalSeparator.setFillColor(GreyD4);
-    verticalSeparator.setPosition(panelWidth - separatorWidth/2.f, windowHeight - panelHeight);
-
-    // Creamos el campo donde se mostraran los mensajes
-    sf::RectangleShape bannerField;
-    bannerField.setSize(sf::Vector2<float>(windowWidth, windowHeight - panelHeight));
-    bannerField.setPosition(0, 0);
-    bannerField.setTexture(&flagTexture);
-    bannerField.setTextureRect(sf::IntRect(0, 0, windowWidth, windowHeight - panelHeight));
-
-    // Creamos el campo (donde se movera la pelotita) ...
-    sf::RectangleShape panelField;
-    panelField.setSize(sf::Vector2<float>(panelWidth, panelHeight));
-    panelField.setPosition(0, windowHeight - panelHeight);
-    panelField.setTexture(&grassTexture);
-
-    // ... y el espejo (donde se moverá su reflejo)
-    sf::RectangleShape mirrorField = panelField;
-    mirrorField.setPosition(panelWidth, windowHeight - panelHeight);
-
-    // Creamos los obstáculos
-    std::array<sf::RectangleShape, nObstacles> fieldObstacles;
-
-    for (auto& obstacle : fieldObstacles) {
-        obstacle.setSize(obstacleSize);
-        obstacle.setOrigin(0.5f*obstacle.getSize());
-        obstacle.setTexture(&brickTexture);
-    }
+    prewarmTexts(welcomeTexts);
 
-    fieldObstacles[0].setPosition(panelWidth/3.f, panelHeight/3.f + (windowHeight - panelHeight));
-    fieldObstacles[1].setPosition(panelWidth/3.f, 2*panelHeight/3.f + (windowHeight - panelHeight));
-    fieldObstacles[2].setPosition(2*panelWidth/3.f, panelHeight/3.f + (windowHeight - panelHeight));
-    fieldObstacles[3].setPosition(2*panelWidth/3.f, 2*panelHeight/3.f + (windowHeight - panelHeight));
-
-    std::array<sf::RectangleShape, nObstacles> mirrorObstacles = fieldObstacles;
-
-    mirrorObstacles[0].setPosition(windowWidth - fieldObstacles[0].getPosition().x, fieldObstacles[0].getPosition().y);
-    mirrorObstacles[1].setPosition(windowWidth - fieldObstacles[1].getPosition().x, fieldObstacles[1].getPosition().y);
-    mirrorObstacles[2].setPosition(windowWidth - fieldObstacles[2].getPosition().x, fieldObstacles[2].getPosition().y);
-    mirrorObstacles[3].setPosition(windowWidth - fieldObstacles[3].getPosition().x, fieldObstacles[3].getPosition().y);
-
-    // Circulo movil
-    sf::CircleShape ball(ballRadius);
-    // ball.setOutlineThickness(borderWidth);
-    // ball.setOutlineColor(GreyD4);
-    ball.setFillColor(GreyL4);
-    ball.setOrigin(ballRadius, ballRadius);
-    ball.setTexture(&ballTexture);
-
-    // Clones del circulo para las animaciones
-    sf::CircleShape mirrorBall = ball;
-    sf::CircleShape homoteticBall(ballRadius);
-    homoteticBall.setFillColor(GreyL4);
-
-    sf::Vertex homoteticAxis[2] = {
-        sf::Vertex(sf::Vector2f(0,0), Red),
-        sf::Vertex(sf::Vector2f(0,0), Red)
-    };
-    homoteticAxis[0] = ball.getPosition();
+    // Paneles, obstáculos, pelotas y banner (el mismo dibujo que en el modo
+    // por software)
+    WindowCanvas canvas(window, sceneStyle, fontSansation, ballTexture, brickTexture, flagTexture, grassTexture);
+
+    // Animación de la transformación activa
+    EffectAnimation animation;
 
     // Controlador de tiempo
     sf::Clock clock;
@@ -326,569 +572,292 @@ int main() {
     bool isPlaying = false;
     bool isPause = true;
 
-    bool homothecyEnabled = false;
-    bool symmetryEnabled = false;
-    bool rotationEnabled = false;
-    bool colission = false;
+    // Contadores de memoria por cuadro (--frame-stats)
+    sf::Clock statsClock;
+    unsigned long statsFrames = 0;
+    unsigned long statsAllocations = 0;
 
-    // Effecto especial
-    bool specialEffect = false;
+    // Redibujado en reposo:
+    // En la pantalla de bienvenida y durante la pausa la escena no cambia, asi
+    // que el bucle se bloquea esperando eventos (waitEvent) y solo se vuelve a
+    // dibujar cuando llega una entrada o la ventana necesita repintarse.
+    bool needsRedraw = true;
 
-    std::array<sf::Vector2f, nObstacles> angularVelocities;
-    angularVelocities[0] = sf::Vector2f(static_cast<float>(angleDistribution() % 90), static_cast<float>(angleDistribution() % 90)) / 90.f;
-    angularVelocities[1] = sf::Vector2f(static_cast<float>(angleDistribution() % 90), static_cast<float>(angleDistribution() % 90)) / 90.f;
-    angularVelocities[2] = sf::Vector2f(static_cast<float>(angleDistribution() % 90), static_cast<float>(angleDistribution() % 90)) / 90.f;
-    angularVelocities[3] = sf::Vector2f(static_cast<float>(angleDistribution() % 90), static_cast<float>(angleDistribution() % 90)) / 90.f;
+    // Ajusta la simulación y la animación a la escena actual (al iniciar y
+    // después de cada recarga)
+    auto applyScene = [&]() {
+        simulation.setScene(scene);
 
-    std::array<float, nObstacles> phases;
-    phases[0] = static_cast<float>(angleDistribution() % 10)*pi/40;
-    phases[1] = static_cast<float>(angleDistribution() % 10)*pi/40;
-    phases[2] = static_cast<float>(angleDistribution() % 10)*pi/40;
-    phases[3] = static_cast<float>(angleDistribution() % 10)*pi/40;
+        // Las instantáneas anteriores no corresponden a la nueva escena
+        history.clear();
 
-    // Bucle principal de animación
-    while (window.isOpen()) {
-        // Recivimos todos los eventos en el bucle de la animacion
-        sf::Event event;
+        if (isPlaying) {
+            history.capture(simulation);
+        }
 
-        while (window.pollEvent(event)) {
-            // "Window closed" o "ESC": exit (salir)
-            if ((event.type == sf::Event::Closed) ||
-               ((event.type == sf::Event::KeyPressed) && (event.key.code == sf::Keyboard::Escape))) {
-                window.close();
-                break;
-            }
+        animation.reset(simulation.getEffect(), simulation.getBallRadius());
+    };
 
-            // "SAPCE": Inicia la animación (iniciar o pausar)
-            if ((event.type == sf::Event::KeyPressed) && (event.key.code == sf::Keyboard::Space)) {
-                if (!isPlaying) {
-                    // (re)inicar la animacion
-                    isPlaying = true;
-                    isPause = false;
-                    clock.restart();
+    applyScene();
+
+    // En el modo --benchmark la animación empieza sin esperar a la barra
+    // espaciadora
+    if (benchmarkFrames > 0) {
+        isPlaying = true;
+        isPause = false;
+        simulation.setSpecialEffect(batchSettings.specialEffect);
+        simulation.start();
+        history.capture(simulation);
+        clock.restart();
+    }
 
-                    ball.setPosition((panelWidth / 2), (panelHeight / 2) + (windowHeight - panelHeight));
+    // Después de retroceder, la animación continúa desde el instante elegido
+    bool isScrubbing = false;
+
+    // Última vez que se vació la cola de eventos: una entrada leída después
+    // llegó en algún momento desde entonces
+    TimeStamp drained = std::chrono::steady_clock::now();
+
+    // Atiende un evento. SFML no marca la hora de los eventos, así que se usa
+    // el instante en que se leen de la cola (received).
+    auto handleEvent = [&](const sf::Event& event, TimeStamp received, FrameVector<InputStamp>& inputs) {
+        InputStamp input;
+        input.queued = drained;
+        input.received = received;
+        input.simulated = received;
+
+        // "Window closed" o "ESC": exit (salir)
+        if ((event.type == sf::Event::Closed) ||
+           ((event.type == sf::Event::KeyPressed) && (event.key.code == sf::Keyboard::Escape))) {
+            window.close();
+            return;
+        }
 
-                    // Elegimos el ángulo de inicio
-                    do {
-                        ballAngle = static_cast<float>(angleDistribution() % 360) * pi / 180.f;
-                    }
-                    while (ballAngle < pi/3.f || (2.f*pi/3.f < ballAngle && ballAngle < 4.f*pi/3.f) || 5*pi/3.f < ballAngle);
-                }
-                else {
-                    // pausamos el programa
-                    isPause = !isPause;
-                    clock.restart();
+        // La ventana debe repintarse (cambio de tamaño o recupera el foco)
+        if ((event.type == sf::Event::Resized) || (event.type == sf::Event::GainedFocus)) {
+            needsRedraw = true;
+        }
+
+        // "SAPCE": Inicia la animación (iniciar o pausar)
+        if ((event.type == sf::Event::KeyPressed) && (event.key.code == sf::Keyboard::Space)) {
+            if (!isPlaying) {
+                // (re)inicar la animacion
+                isPlaying = true;
+                isPause = false;
+                clock.restart();
+
+                // Pelotas al centro con ángulos de inicio al azar
+                simulation.start();
+
+                history.clear();
+                history.capture(simulation);
+            }
+            else {
+                // pausamos el programa
+                isPause = !isPause;
+                clock.restart();
+
+                // Se descarta lo que había después del instante elegido
+                if (!isPause && isScrubbing) {
+                    history.truncate(simulation);
+                    isScrubbing = false;
                 }
             }
 
-            // activamos el efecto especial
-            if ((event.type == sf::Event::KeyPressed) && (event.key.code == sf::Keyboard::R)) {
-                if (isPlaying && !isPause) {
-                    specialEffect = !specialEffect;
+            needsRedraw = true;
+            inputs.push_back(input);
+        }
 
-                    // if(!specialEffect) {
-                    //     time = 0.f;
-                    // }
-                }
+        // activamos el efecto especial
+        if ((event.type == sf::Event::KeyPressed) && (event.key.code == sf::Keyboard::R)) {
+            if (isPlaying && !isPause) {
+                simulation.setSpecialEffect(!simulation.hasSpecialEffect());
+                history.capture(simulation);
+                needsRedraw = true;
+                inputs.push_back(input);
+
+                // if(!specialEffect) {
+                //     time = 0.f;
+                // }
             }
         }
 
-        if (isPlaying) {
-            if(!isPause) {
-                colission = false;
+        // "LEFT" y "RIGHT": durante la pausa retrocede o avanza un cuadro (un
+        // segundo con SHIFT)
+        if ((event.type == sf::Event::KeyPressed) &&
+           ((event.key.code == sf::Keyboard::Left) || (event.key.code == sf::Keyboard::Right))) {
+            if (isPlaying && isPause && !history.isEmpty()) {
+                long direction = (event.key.code == sf::Keyboard::Left) ? -1 : 1;
+                bool moved = false;
+
+                if (event.key.shift) {
+                    float target = simulation.getElapsedTime() + static_cast<float>(direction);
+                    moved = history.seek(simulation, std::max(history.getBegin(), std::min(history.getEnd(), target)));
+                }
+                else {
+                    // Un cuadro registrado, sin importar cuánto duró
+                    moved = history.stepBy(simulation, direction);
+                }
 
-                float deltaTime = clock.restart().asSeconds();
+                if (moved) {
+                    isScrubbing = true;
 
-                if(specialEffect) {
-                    time += deltaTime;
-
-                    fieldObstacles[0].setPosition(
-                        30.f*std::sin(10.f*angularVelocities[0].x*time + phases[0]) + panelWidth/3.f,
-                        30.f*std::sin(10.f*angularVelocities[0].y*time) + panelHeight/3.f + (windowHeight - panelHeight)
-                    );
-                    fieldObstacles[1].setPosition(
-                        30.f*std::sin(10.f*angularVelocities[1].x*time + phases[1]) + panelWidth/3.f,
-                        30.f*std::sin(10.f*angularVelocities[1].y*time) + 2*panelHeight/3.f + (windowHeight - panelHeight)
-                    );
-                    fieldObstacles[2].setPosition(
-                        30.f*std::sin(10.f*angularVelocities[2].x*time + phases[2]) + 2*panelWidth/3.f,
-                        30.f*std::sin(10.f*angularVelocities[2].y*time) + panelHeight/3.f + (windowHeight - panelHeight)
-                    );
-                    fieldObstacles[3].setPosition(
-                        30.f*std::sin(10.f*angularVelocities[3].x*time + phases[3]) + 2*panelWidth/3.f,
-                        30.f*std::sin(10.f*angularVelocities[3].y*time) + 2*panelHeight/3.f + (windowHeight - panelHeight)
-                    );
+                    // Transformación activa en ese instante
+                    animation.reset(simulation.getEffect(), simulation.getBallRadius());
+
+                    needsRedraw = true;
+                    inputs.push_back(input);
                 }
+            }
+        }
+    };
 
-                float yError = 0;
-                float xError = 0;
+    // Latencias de las entradas (--latency)
+    LatencyRecorder latencyRecorder(4096);
 
-                float xLeft = 0;
-                float xRight = panelWidth;
-                float yTop = windowHeight - panelHeight;
-                float yBottom = windowHeight;
+    // Últimos cuadros, volcados cuando uno excede el presupuesto
+    FlightRecorder flightRecorder(300, hitchBudget/1000.0, hitchPrefix);
 
-                // Movemos la bolita
-                float factor = ballSpeed * deltaTime;
+    // Momento de la lectura tardía (--late-latch)
+    FramePacer framePacer;
 
-                ball.move(std::cos(ballAngle) * factor, std::sin(ballAngle) * factor);
+    // Bucle principal de animación
+    while (window.isOpen()) {
+        // Asignaciones en el heap desde el inicio de la vuelta, incluidos los
+        // eventos y la recarga de la escena (--frame-stats)
+        unsigned long frameAllocations = getHeapAllocations();
 
-                // Verificamos choques con los extremos de la pantalla
+        // Todo lo asignado en la arena durante el cuadro anterior se descarta
+        frameArena.reset();
 
-                // Si hay impacto con el borde izquierdo
-                if(ball.getPosition().x - ballRadius < xLeft) {
-                    ballSound.play();
-                    ballAngle = ((ballAngle < pi)?(1):(3))*pi - ballAngle;
-                    xError = xLeft - ball.getPosition().x + ballRadius;
-                    ball.setPosition(ball.getPosition().x + 2*xError, ball.getPosition().y);
-                    colission = true;
-                }
+        // Recivimos todos los eventos en el bucle de la animacion
+        sf::Event event;
 
-                // Si hay impacto con el borde derecho
-                if(ball.getPosition().x + ballRadius > xRight) {
-                    ballSound.play();
-                    ballAngle = ((ballAngle < pi)?(1):(3))*pi - ballAngle;
-                    xError = ball.getPosition().x + ballRadius - xRight;
-                    ball.setPosition(ball.getPosition().x - 2*xError, ball.getPosition().y);
-                    colission = true;
+        // Entradas que cambian la animación en este cuadro
+        FrameVector<InputStamp> inputs((ArenaAllocator<InputStamp>(frameArena)));
+
+        // En reposo esperamos el primer evento sin consumir CPU (fuera de las
+        // mediciones del cuadro), el resto de eventos pendientes se leen sin
+        // bloquear.
+        bool isIdle = !isPlaying || isPause;
+        bool hasEvent = false;
+        bool sceneChanged = false;
+
+        if (isIdle && !needsRedraw) {
+            if (sceneWatcher.isWatching()) {
+                // Con una escena vigilada no se puede bloquear en waitEvent:
+                // se revisan los eventos y el archivo cada 50 ms
+                while (!(hasEvent = window.pollEvent(event)) && !(sceneChanged = sceneWatcher.hasChanged())) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(50));
                 }
+            }
+            else {
+                hasEvent = window.waitEvent(event);
+            }
+        }
 
-                // Si hay impacto con el borde superior
-                if(ball.getPosition().y - ballRadius < yTop) {
-                    ballSound.play();
-                    ballAngle = 2*pi - ballAngle;
-                    yError = yTop - ball.getPosition().y + ballRadius;
-                    ball.setPosition(ball.getPosition().x, ball.getPosition().y + 2*yError);
-                    colission = true;
-                }
+        if (hasEvent) {
+            // El evento que despertó el bucle acaba de llegar
+            drained = std::chrono::steady_clock::now();
+        }
+        else if (lateLatch && !isIdle) {
+            // Lectura tardía: durante la animación se espera hasta poco antes
+            // de la siguiente sincronización vertical. Las teclas que llegan
+            // mientras tanto se leen, simulan y presentan en este cuadro en
+            // lugar de esperar en la cola durante su display().
+            std::this_thread::sleep_until(framePacer.getLatchTime());
+        }
 
-                // Si hay impacto con el borde inferior
-                if(ball.getPosition().y + ballRadius > yBottom) {
-                    ballSound.play();
-                    ballAngle = 2*pi - ballAngle;
-                    yError = ball.getPosition().y + ballRadius - yBottom;
-                    ball.setPosition(ball.getPosition().x, ball.getPosition().y - 2*yError);
-                    colission = true;
-                }
+        TimeStamp prepareStart = std::chrono::steady_clock::now();
 
-                // Verificamos choques con los obstaculos
-                for(auto& obstacle: fieldObstacles) {
-                    // Lado izquierdo del obstáculo
-                    xLeft = obstacle.getPosition().x - obstacleSize.x/2;
-
-                    // Lado derecho del obstáculo
-                    xRight = obstacle.getPosition().x + obstacleSize.x/2;
-
-                    // Lado superior del obstáculo
-                    yTop = obstacle.getPosition().y - obstacleSize.y/2;
-
-                    // Lado inferior del obstáculo
-                    yBottom = obstacle.getPosition().y + obstacleSize.y/2;
-
-                    // Si la pelota se acerca al cuadrado por la izquierda
-                    if( ball.getPosition().x + ballRadius > xLeft &&
-                        ball.getPosition().x + ballRadius < obstacle.getPosition().x &&
-                        ball.getPosition().y >= yTop &&
-                        ball.getPosition().y <= yBottom
-                    ) {
-                        ballSound.play();
-                        ballAngle = ((ballAngle < pi)?(1):(3))*pi - ballAngle;
-                        xError = ball.getPosition().x + ballRadius - xLeft;
-                        ball.setPosition(ball.getPosition().x - 2*xError, ball.getPosition().y);
-                        colission = true;
-                    }
+        flightRecorder.beginFrame();
+        flightRecorder.begin(EventsPhase);
+        perfCounters.begin(EventsPhase);
 
-                    // Si la pelota se acerca al cuadrado por la derecha
-                    if( ball.getPosition().x - ballRadius < xRight &&
-                        ball.getPosition().x - ballRadius > obstacle.getPosition().x &&
-                        ball.getPosition().y >= yTop &&
-                        ball.getPosition().y <= yBottom
-                    ) {
-                        ballSound.play();
-                        ballAngle = ((ballAngle < pi)?(1):(3))*pi - ballAngle;
-                        xError = xRight - ball.getPosition().x + ballRadius;
-                        ball.setPosition(ball.getPosition().x + 2*xError, ball.getPosition().y);
-                        colission = true;
-                    }
+        if (!hasEvent) {
+            hasEvent = window.pollEvent(event);
+        }
 
-                    // Si la pelota se acerca al cuadrado por arriba
-                    if( ball.getPosition().y + ballRadius > yTop &&
-                        ball.getPosition().y + ballRadius < obstacle.getPosition().y &&
-                        ball.getPosition().x >= xLeft &&
-                        ball.getPosition().x <= xRight
-                    ) {
-                        ballSound.play();
-                        ballAngle = 2*pi - ballAngle;
-                        yError = ball.getPosition().y + ballRadius - yTop;
-                        ball.setPosition(ball.getPosition().x, ball.getPosition().y - 2*yError);
-                        colission = true;
-                    }
+        for (; hasEvent && window.isOpen(); hasEvent = window.pollEvent(event)) {
+            handleEvent(event, std::chrono::steady_clock::now(), inputs);
+        }
 
-                    // Si la pelota se acerca al cuadrado por abajo
-                    if( ball.getPosition().y - ballRadius < yBottom &&
-                        ball.getPosition().y - ballRadius > obstacle.getPosition().y &&
-                        ball.getPosition().x >= xLeft &&
-                        ball.getPosition().x <= xRight
-                    ) {
-                        ballSound.play();
-                        ballAngle = 2*pi - ballAngle;
-                        yError = yBottom - ball.getPosition().y + ballRadius;
-                        ball.setPosition(ball.getPosition().x, ball.getPosition().y + 2*yError);
-                        colission = true;
-                    }
+        drained = std::chrono::steady_clock::now();
 
-                    // Si la pelota se acerca al cuadrado por una esquina
-                    // e impacta en ella
-                    float xDistance = std::abs(obstacle.getPosition().x - ball.getPosition().x);
-                    float yDistance = std::abs(obstacle.getPosition().y - ball.getPosition().y);
-                    float cDistance = std::sqrt(std::pow(xDistance - obstacleSize.x / 2.f, 2.f) + std::pow(yDistance - obstacleSize.y / 2.f, 2.f));
-                    float h = 0.f;
-                    float e = 0.f;
-                    float b = 0.f;
-
-                    if (cDistance < ballRadius) {
-                        /*
-                        if(ball.getPosition().x < xLeft && ball.getPosition().y < yTop) {
-                            sf::Vector2f C = {xLeft, yTop};
-                            sf::Vector2f P = ball.getPosition();
-
-                            sf::Vector2f CP = P - C;
-
-                            float R = ballRadius;
-                            float theta = ballAngle;
-
-                            float b = (CP.x*std::cos(theta) + CP.y*std::sin(theta));
-                            float d = std::sqrt(b*b + R*R - CP.x*CP.x - CP.y*CP.y);
-
-                            float t = b + d;
-
-                            sf::Vector2f O = P - t*sf::Vector2f(std::cos(theta), std::sin(theta));
-
-                            if (O.x >= xLeft || O.y >= yTop) {
-
-                            }
-                            float t = b - d;
-                        }
-                        */
-
-                        // La pelota llega por la esquina superior izquierda
-                        if(ball.getPosition().x < xLeft && ball.getPosition().y < yTop) {
-                            ballSound.play();
-                            h = xLeft*std::sin(ballAngle) - yTop*std::cos(ballAngle) + ball.getPosition().y*std::cos(ballAngle) - ball.getPosition().x*std::sin(ballAngle);
-                            h = std::abs(h);
-
-                            std::cout << "-- Impacto --" << std::endl;
-                            std::cout << "Parámetros del obstáculo" << std::endl;
-                            std::cout << "xLeft:   " << xLeft   << std::endl;
-                            std::cout << "xRight:  " << xRight  << std::endl;
-                            std::cout << "yTop:    " << yTop    << std::endl;
-                            std::cout << "yBottom: " << yBottom << std::endl;
-                            std::cout << "Parámetros de la pelota" << std::endl;
-                            std::cout << "X    : " << ball.getPosition().x << std::endl;
-                            std::cout << "Y    : " << ball.getPosition().y << std::endl;
-                            std::cout << "Angle: " << ballAngle*180/pi << std::endl;
-                            std::cout << "Distancia del centro de la esfera a la recta de impacto" << std::endl;
-                            std::cout << "h = |"
-                                      << xRight << "*" << std::sin(ballAngle) << "-"
-                                      << yTop << "*" << std::cos(ballAngle) << "+"
-                                      << ball.getPosition().y << "*" << std::cos(ballAngle) << "-"
-                                      << ball.getPosition().x << "*" << std::sin(ballAngle)
-                                      << "|" << std::endl;
-                            std::cout << "h = |"
-                                      << xRight*std::sin(ballAngle) << "-"
-                                      << yTop*std::cos(ballAngle) << "+"
-                                      << ball.getPosition().y*std::cos(ballAngle) << "-"
-                                      << ball.getPosition().x*std::sin(ballAngle)
-                                      << "|" << std::endl;
-                            std::cout << "h = " << h << std::endl;
-
-                            b = std::asin(h/ballRadius);
-                            e = ballRadius*std::cos(b) - std::sqrt(cDistance*cDistance - h*h);
-                            ball.setPosition(ball.getPosition().x - e*std::cos(ballAngle), ball.getPosition().y - e*std::sin(ballAngle));
-
-                            if(0 <= ballAngle && ballAngle < pi/2) {
-                                ballAngle = ballAngle + 2*b + pi;
-                            }
-                            if (pi/2 <= ballAngle && ballAngle < pi) {
-                                ballAngle = pi + ballAngle - 2*b;
-                            }
-                            // if (pi <= ballAngle && ballAngle < 3*pi/2) {
-                            //     ballAngle = pi + ballAngle - 2*b;
-                            // }
-                            if (3*pi/2 <= ballAngle && ballAngle < 2*pi) {
-                                ballAngle = ballAngle + 2*b - pi;
-                            }
-
-                            std::cout << "Angulo de corte : " << b*180/pi << std::endl;
-                            std::cout << "Angulo de rebote: " << ballAngle*180/pi << std::endl;
-
-                            ball.setPosition(ball.getPosition().x + e*std::cos(ballAngle), ball.getPosition().y + e*std::sin(ballAngle));
-                            colission = true;
-                        }
-
-                        // La pelota llega por la esquina inferior izquieda
-                        if(ball.getPosition().x < xLeft && ball.getPosition().y > yBottom) {
-                            ballSound.play();
-                            h = xLeft*std::sin(ballAngle) - yBottom*std::cos(ballAngle) + ball.getPosition().y*std::cos(ballAngle) - ball.getPosition().x*std::sin(ballAngle);
-                            h = std::abs(h);
-
-                            std::cout << "-- Impacto --" << std::endl;
-                            std::cout << "Parámetros del obstáculo" << std::endl;
-                            std::cout << "xLeft:   " << xLeft   << std::endl;
-                            std::cout << "xRight:  " << xRight  << std::endl;
-                            std::cout << "yTop:    " << yTop    << std::endl;
-                            std::cout << "yBottom: " << yBottom << std::endl;
-                            std::cout << "Parámetros de la pelota" << std::endl;
-                            std::cout << "X    : " << ball.getPosition().x << std::endl;
-                            std::cout << "Y    : " << ball.getPosition().y << std::endl;
-                            std::cout << "Angle: " << ballAngle*180/pi << std::endl;
-                            std::cout << "Distancia del centro de la esfera a la recta de impacto" << std::endl;
-                            std::cout << "h = |"
-                                      << xRight << "*" << std::sin(ballAngle) << "-"
-                                      << yTop << "*" << std::cos(ballAngle) << "+"
-                                      << ball.getPosition().y << "*" << std::cos(ballAngle) << "-"
-                                      << ball.getPosition().x << "*" << std::sin(ballAngle)
-                                      << "|" << std::endl;
-                            std::cout << "h = |"
-                                      << xRight*std::sin(ballAngle) << "-"
-                                      << yTop*std::cos(ballAngle) << "+"
-                                      << ball.getPosition().y*std::cos(ballAngle) << "-"
-                                      << ball.getPosition().x*std::sin(ballAngle)
-                                      << "|" << std::endl;
-                            std::cout << "h = " << h << std::endl;
-
-                            b = std::asin(h/ballRadius);
-                            e = ballRadius*std::cos(b) - std::sqrt(cDistance*cDistance - h*h);
-                            ball.setPosition(ball.getPosition().x - e*std::cos(ballAngle), ball.getPosition().y - e*std::sin(ballAngle));
-
-                            if(0 <= ballAngle && ballAngle < pi/2) {
-                                ballAngle = pi + ballAngle - 2*b;
-                            }
-                            else if (pi/2 <= ballAngle && ballAngle < 3*pi/2) {
-                                ballAngle = pi + ballAngle + 2*b;
-                            } else {
-                                ballAngle = ballAngle - pi + 2*b;
-                            }
-
-                            std::cout << "Angulo de corte : " << b*180/pi << std::endl;
-                            std::cout << "Angulo de rebote: " << ballAngle*180/pi << std::endl;
-
-                            ball.setPosition(ball.getPosition().x + e*std::cos(ballAngle), ball.getPosition().y + e*std::sin(ballAngle));
-                            colission = true;
-                        }
-
-                        // La pelota llega por la esquina inferior derecha
-                        if(ball.getPosition().x > xRight && ball.getPosition().y > yBottom) {
-                            ballSound.play();
-                            h = xRight*std::sin(ballAngle) - yBottom*std::cos(ballAngle) + ball.getPosition().y*std::cos(ballAngle) - ball.getPosition().x*std::sin(ballAngle);
-                            h = std::abs(h);
-
-                            std::cout << "-- Impacto --" << std::endl;
-                            std::cout << "Parámetros del obstáculo" << std::endl;
-                            std::cout << "xLeft:   " << xLeft   << std::endl;
-                            std::cout << "xRight:  " << xRight  << std::endl;
-                            std::cout << "yTop:    " << yTop    << std::endl;
-                            std::cout << "yBottom: " << yBottom << std::endl;
-                            std::cout << "Parámetros de la pelota" << std::endl;
-                            std::cout << "X    : " << ball.getPosition().x << std::endl;
-                            std::cout << "Y    : " << ball.getPosition().y << std::endl;
-                            std::cout << "Angle: " << ballAngle*180/pi << std::endl;
-                            std::cout << "Distancia del centro de la esfera a la recta de impacto" << std::endl;
-                            std::cout << "h = |"
-                                      << xRight << "*" << std::sin(ballAngle) << "-"
-                                      << yTop << "*" << std::cos(ballAngle) << "+"
-                                      << ball.getPosition().y << "*" << std::cos(ballAngle) << "-"
-                                      << ball.getPosition().x << "*" << std::sin(ballAngle)
-                                      << "|" << std::endl;
-                            std::cout << "h = |"
-                                      << xRight*std::sin(ballAngle) << "-"
-                                      << yTop*std::cos(ballAngle) << "+"
-                                      << ball.getPosition().y*std::cos(ballAngle) << "-"
-                                      << ball.getPosition().x*std::sin(ballAngle)
-                                      << "|" << std::endl;
-                            std::cout << "h = " << h << std::endl;
-
-                            b = std::asin(h/ballRadius);
-                            e = ballRadius*std::cos(b) - std::sqrt(cDistance*cDistance - h*h);
-                            ball.setPosition(ball.getPosition().x - e*std::cos(ballAngle), ball.getPosition().y - e*std::sin(ballAngle));
-
-                            if(0 <= ballAngle && ballAngle < pi/2) {
-                                ballAngle = pi + ballAngle + 2*b;
-                            }
-                            else if (pi/2 <= ballAngle && ballAngle < 3*pi/2) {
-                                ballAngle = pi + ballAngle - 2*b;
-                            } else {
-                                ballAngle = ballAngle - pi - 2*b;
-                            }
-
-                            std::cout << "Angulo de corte : " << b*180/pi << std::endl;
-                            std::cout << "Angulo de rebote: " << ballAngle*180/pi << std::endl;
-
-                            ball.setPosition(ball.getPosition().x + e*std::cos(ballAngle), ball.getPosition().y + e*std::sin(ballAngle));
-                            colission = true;
-                        }
-
-                        // La pelota llega por la esquina superior derecha
-                        if(ball.getPosition().x > xRight && ball.getPosition().y < yTop) {
-                            ballSound.play();
-
-                            h = xRight*std::sin(ballAngle) - yTop*std::cos(ballAngle) + ball.getPosition().y*std::cos(ballAngle) - ball.getPosition().x*std::sin(ballAngle);
-
-                            h = std::abs(h);
-
-                            std::cout << "-- Impacto --" << std::endl;
-                            std::cout << "Parámetros del obstáculo" << std::endl;
-                            std::cout << "xLeft:   " << xLeft   << std::endl;
-                            std::cout << "xRight:  " << xRight  << std::endl;
-                            std::cout << "yTop:    " << yTop    << std::endl;
-                            std::cout << "yBottom: " << yBottom << std::endl;
-                            std::cout << "Parámetros de la pelota" << std::endl;
-                            std::cout << "X    : " << ball.getPosition().x << std::endl;
-                            std::cout << "Y    : " << ball.getPosition().y << std::endl;
-                            std::cout << "Angle: " << ballAngle << std::endl;
-                            std::cout << "Distancia del centro de la esfera a la recta de impacto" << std::endl;
-                            std::cout << "h = |"
-                                      << xRight << "*" << std::sin(ballAngle) << "-"
-                                      << yTop << "*" << std::cos(ballAngle) << "+"
-                                      << ball.getPosition().y << "*" << std::cos(ballAngle) << "-"
-                                      << ball.getPosition().x << "*" << std::sin(ballAngle)
-                                      << "|" << std::endl;
-                            std::cout << "h = |"
-                                      << xRight*std::sin(ballAngle) << "-"
-                                      << yTop*std::cos(ballAngle) << "+"
-                                      << ball.getPosition().y*std::cos(ballAngle) << "-"
-                                      << ball.getPosition().x*std::sin(ballAngle)
-                                      << "|" << std::endl;
-                            std::cout << "h = " << h << std::endl;
-
-                            b = std::asin(h/ballRadius);
-                            e = ballRadius*std::cos(b) - std::sqrt(cDistance*cDistance - h*h);
-                            ball.setPosition(ball.getPosition().x - e*std::cos(ballAngle), ball.getPosition().y - e*std::sin(ballAngle));
-
-                            if(ballAngle <= pi) {
-                                ballAngle = pi + ballAngle + 2*b;
-                            }
-                            else {
-                                ballAngle = pi + ballAngle - 2*b;
-                            }
-
-                            ball.setPosition(ball.getPosition().x + e*std::cos(ballAngle), ball.getPosition().y + e*std::sin(ballAngle));
-                            colission = true;
-                        }
-                    }
-                }
-            }
+        perfCounters.end(EventsPhase);
+        flightRecorder.end(EventsPhase);
+
+        if (!window.isOpen()) {
+            break;
         }
 
-        if (isPlaying) {
-            // Limpiamos la pantalla
-            window.clear(GreyD4);
-            // Dibujar páneles, obstaculos, la esfra y los efectos
-            // de transformación
-            window.draw(panelField);
-
-            if(colission) {
-                if(!isPause) {
-                    homothecyEnabled = false;
-                    symmetryEnabled = false;
-                    rotationEnabled = false;
-
-                    // Desactivar animaciones
-                    homoteticBall.setRadius(ballRadius);
-                    homoteticAxis[0].position = sf::Vector2f(0,0);
-                    homoteticAxis[1].position = sf::Vector2f(0,0);
-
-                    // Selecionar nueva animación
-                    int effect = effectDistribution() % 3;
-
-                    homothecyEnabled = (effect == 0);
-                    symmetryEnabled = (effect == 1);
-                    rotationEnabled = (effect == 2);
-                }
+        // Recarga en caliente de la escena (también en reposo, la nueva escena
+        // se dibuja en seguida)
+        if (sceneChanged || sceneWatcher.hasChanged()) {
+            Scene reloaded;
+
+            if (reloaded.loadFromFile(scenePath)) {
+                scene.swap(reloaded);
+                applyScene();
+                needsRedraw = true;
             }
+        }
 
-            // Habilitar animaciones
-            if(homothecyEnabled) {
-                // Código de homotecia
-                banner[1].setString(L"Homotecia");
-                // banner[1].setPosition(10 + banner[0].getLocalBounds().left + banner[0].getLocalBounds().width, 0.5f*(windowHeight - panelHeight - banner[1].getLocalBounds().height));
-
-                if (!isPause) {
-                    // homoteticBall = ball;
-                    // homoteticBall.setFillColor(Amber);
-                    // sf::Vector2f scale = homoteticBall.getScale();
-                    // homoteticBall.setPosition(ball.getPosition().x, ball.getPosition().y);
-                    // homoteticBall.scale(1.01f, 1.01f);
-                    float homoteticRadius = homoteticBall.getRadius();
-                    homoteticRadius += 0.5f;
-                    homoteticBall.setRadius(homoteticRadius);
-                    homoteticBall.setOrigin(homoteticRadius, homoteticRadius);
-                    homoteticBall.setPosition(ball.getPosition().x, ball.getPosition().y);
-
-                    if (homoteticAxis[0].position == sf::Vector2f(0,0)) {
-                        homoteticAxis[0].position = ball.getPosition();
-                    }
-                    homoteticAxis[1].position = ball.getPosition();
+        // En reposo no hay nada nuevo que mostrar
+        if ((!isPlaying || isPause) && !needsRedraw) {
+            continue;
+        }
 
-                    window.draw(homoteticBall);
-                }
-            }
+        needsRedraw = false;
 
-            if(rotationEnabled) {
-                // Código de rotación
-                banner[1].setString(L"Rotación");
-                // banner[1].setPosition(10 + banner[0].getLocalBounds().left + banner[0].getLocalBounds().width, 0.5f*(windowHeight - panelHeight - banner[1].getLocalBounds().height));
+        // Listas del cuadro actual
+        ContactList contacts((ArenaAllocator<Contact>(frameArena)));
 
-                if (!isPause) {
-                    ball.rotate(5);
-                }
-            }
+        flightRecorder.begin(PhysicsPhase);
+        perfCounters.begin(PhysicsPhase);
 
-            window.draw(mirrorField);
-            window.draw(verticalSeparator);
+        if (isPlaying) {
+            if(!isPause) {
+                float deltaTime = clock.restart().asSeconds();
 
-            for (auto& obstacle : mirrorObstacles) {
-                window.draw(obstacle);
-            }
+                // Movemos las bolitas y verificamos choques con los extremos
+                // del panel y con los obstaculos
+                bool colission = simulation.step(deltaTime, &contacts);
+                history.record(simulation, deltaTime);
+                flightRecorder.setDeltaTime(deltaTime);
+                flightRecorder.addContacts(contacts);
 
-            window.draw(ball);
+                // Un solo "boing!" por cuadro aunque haya varios choques
+                if (!contacts.empty()) {
+                    ballSound.play();
+                }
 
-            if(homothecyEnabled) {
-                if (!isPause) {
-                    window.draw(homoteticAxis, 2, sf::Lines);
+                // Nueva animación elegida por la simulación
+                if (colission) {
+                    animation.reset(simulation.getEffect(), simulation.getBallRadius());
                 }
-            }
 
-            if (specialEffect) {
-                mirrorObstacles[0].setPosition(windowWidth - fieldObstacles[0].getPosition().x, fieldObstacles[0].getPosition().y);
-                mirrorObstacles[1].setPosition(windowWidth - fieldObstacles[1].getPosition().x, fieldObstacles[1].getPosition().y);
-                mirrorObstacles[2].setPosition(windowWidth - fieldObstacles[2].getPosition().x, fieldObstacles[2].getPosition().y);
-                mirrorObstacles[3].setPosition(windowWidth - fieldObstacles[3].getPosition().x, fieldObstacles[3].getPosition().y);
+                animation.advance(simulation.getBall(0).position);
             }
+        }
 
-            for (auto& obstacle : fieldObstacles) {
-                window.draw(obstacle);
-            }
+        TimeStamp simulated = std::chrono::steady_clock::now();
 
-            if(symmetryEnabled) {
-                banner[1].setString(L"Simetría");
-                // banner[1].setPosition(10 + banner[0].getLocalBounds().left + banner[0].getLocalBounds().width, 0.5f*(windowHeight - panelHeight - banner[1].getLocalBounds().height));
+        for (auto& input: inputs) {
+            input.simulated = simulated;
+        }
 
-                if (!isPause) {
-                    mirrorBall = ball;
-                    mirrorBall.setPosition(windowWidth - ball.getPosition().x, ball.getPosition().y);
-                    window.draw(mirrorBall);
-                }
-            }
+        flightRecorder.setEffect(simulation.getEffect());
 
-            window.draw(bannerField);
-            window.draw(topSeparator);
+        perfCounters.end(PhysicsPhase);
+        flightRecorder.end(PhysicsPhase);
+        flightRecorder.begin(DrawPhase);
+        perfCounters.begin(DrawPhase);
 
-            // Textos del panel superior
-            for (auto& animation: banner) {
-                window.draw(animation);
-            }
+        if (isPlaying) {
+            // Paneles, obstáculos, la esfera y los efectos de transformación
+            // (en la pausa solo la escena)
+            paintScene(canvas, sceneStyle, simulation, animation, !isPause);
         }
         else {
             // Limpiamos la pantalla
@@ -900,8 +869,85 @@ int main() {
             }
         }
 
+        perfCounters.end(DrawPhase);
+        flightRecorder.end(DrawPhase);
+
         // Fin del cuadro de animacion actual
+        framePacer.addPrepare(std::chrono::duration<double>(std::chrono::steady_clock::now() - prepareStart).count());
+
+        flightRecorder.begin(DisplayPhase);
+        perfCounters.begin(DisplayPhase);
         window.display();
+        perfCounters.end(DisplayPhase);
+        flightRecorder.end(DisplayPhase);
+
+        // Latencia desde la lectura de cada entrada hasta la presentación
+        TimeStamp presented = std::chrono::steady_clock::now();
+        framePacer.addPresent(presented);
+
+        for (const auto& input: inputs) {
+            latencyRecorder.add(input, presented);
+        }
+
+        if (benchmarkFrames > 0) {
+            if (perFrame) {
+                perfCounters.printFrame(std::cout, perfCounters.getFrames() == 0);
+            }
+
+            perfCounters.endFrame();
+
+            if (perfCounters.getFrames() >= benchmarkFrames) {
+                perfCounters.printTotals(std::cout);
+                window.close();
+            }
+        }
+
+        // Registro de los impactos con las esquinas (fuera del dibujo del
+        // cuadro, con una sola descarga de la salida). En el modo --benchmark
+        // la salida estándar queda solo para el CSV y los totales.
+        if (benchmarkFrames == 0) {
+            for (const auto& contact: contacts) {
+                if (contact.kind == CornerContact) {
+                    std::cout << "-- Impacto --\n"
+                              << "Obstáculo: " << contact.obstacle << "\n"
+                              << "X    : " << contact.position.x << "\n"
+                              << "Y    : " << contact.position.y << "\n"
+                              << "Angle: " << contact.incomingAngle*180/pi << "\n"
+                              << "h = " << contact.h << "\n"
+                              << "Angulo de corte : " << contact.b*180/pi << "\n"
+                              << "Angulo de rebote: " << contact.outgoingAngle*180/pi << "\n";
+                }
+            }
+
+            if (!contacts.empty()) {
+                std::cout.flush();
+            }
+        }
+
+        // Asignaciones en el heap por cuadro (el objetivo es cero)
+        if (frameStats) {
+            statsAllocations += getHeapAllocations() - frameAllocations;
+            statsFrames++;
+
+            if (statsClock.getElapsedTime().asSeconds() >= 1.f) {
+                std::cout << "frames: " << statsFrames
+                          << " heap allocations/frame: " << static_cast<double>(statsAllocations) / static_cast<double>(statsFrames)
+                          << " arena peak: " << frameArena.getPeak() << "/" << frameArena.getCapacity() << " bytes"
+                          << " arena overflows: " << frameArena.getOverflows() << std::endl;
+
+                statsClock.restart();
+                statsFrames = 0;
+                statsAllocations = 0;
+            }
+        }
+
+        // El cuadro se cierra al final de la vuelta: un tirón al escribir los
+        // impactos o las estadísticas también queda registrado
+        flightRecorder.endFrame();
+    }
+
+    if (reportLatency) {
+        latencyRecorder.print(std::cout);
     }
 
     return 0;
@@ -0,0 +1,139 @@
+//****************************************************************************80
+//
+//  PROGRAM    :
+//               GeoT
+//
+//  PURPOSE    :
+//               Program to show Goemetric Transformations as an applied
+//               exploration SFML multimedia library.
+//
+//  PROGRAMMER :
+//               Martín Josemaría <martin.vuelta@gmail.com>
+//
+//               * Software Development and Research
+//                 SoftButterfly
+//                 Lima - Peru
+//
+//               * Faculty of Physical Science
+//                 Universidad Nacional Mayor de San Marcos
+//                 Lima - Peru
+//
+//  FILE       :
+//               memory.cpp
+//
+//  DESCRIPTION:
+//               Per frame arena allocator and heap allocation counters.
+//
+//****************************************************************************80
+
+#include "memory.hpp"
+
+#include <cstdlib>
+
+#include <atomic>
+#include <new>
+
+
+//----------------------------------------------------------------------------80
+//  ARENA DEL CUADRO
+//----------------------------------------------------------------------------80
+FrameArena::FrameArena(std::size_t size) :
+    buffer(static_cast<char*>(std::malloc(size))),
+    capacity(buffer != NULL ? size : 0),
+    used(0),
+    peak(0),
+    overflows(0),
+    overflowBlocks(NULL)
+{
+}
+
+FrameArena::~FrameArena() {
+    reset();
+    std::free(buffer);
+}
+
+void* FrameArena::allocate(std::size_t size, std::size_t alignment) {
+    std::size_t offset = (used + alignment - 1) & ~(alignment - 1);
+
+    if (offset + size <= capacity) {
+        used = offset + size;
+
+        if (used > peak) {
+            peak = used;
+        }
+
+        return buffer + offset;
+    }
+
+    // Desborde: bloque del heap precedido por el enlace de la lista. El enlace
+    // ocupa un max_align_t completo para no romper la alineación.
+    const std::size_t header = alignof(std::max_align_t) > sizeof(Overflow) ? alignof(std::max_align_t) : sizeof(Overflow);
+    char* block = static_cast<char*>(::operator new(header + size));
+
+    Overflow* link = static_cast<Overflow*>(static_cast<void*>(block));
+    link->next = overflowBlocks;
+    overflowBlocks = link;
+    overflows++;
+
+    return block + header;
+}
+
+void FrameArena::reset() {
+    while (overflowBlocks != NULL) {
+        Overflow* next = overflowBlocks->next;
+        ::operator delete(overflowBlocks);
+        overflowBlocks = next;
+    }
+
+    used = 0;
+}
+
+std::size_t FrameArena::getCapacity() const {
+    return capacity;
+}
+
+std::size_t FrameArena::getUsed() const {
+    return used;
+}
+
+std::size_t FrameArena::getPeak() const {
+    return peak;
+}
+
+unsigned long FrameArena::getOverflows() const {
+    return overflows;
+}
+
+
+//----------------------------------------------------------------------------80
+//  CONTADORES DEL HEAP
+//----------------------------------------------------------------------------80
+// Se reemplaza el operator new global solo para contar las llamadas (de
+// cualquier hilo)
+static std::atomic<unsigned long> heapAllocations(0);
+
+unsigned long getHeapAllocations() {
+    return heapAllocations.load(std::memory_order_relaxed);
+}
+
+void* operator new(std::size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+
+    void* pointer = std::malloc(size > 0 ? size : 1);
+
+    if (pointer == NULL) {
+        throw std::bad_alloc();
+    }
+
+    return pointer;
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+#if defined(__cpp_sized_deallocation)
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+#endif
@@ -0,0 +1,128 @@
+//****************************************************************************80
+//
+//  PROGRAM    :
+//               GeoT
+//
+//  PURPOSE    :
+//               Program to show Goemetric Transformations as an applied
+//               exploration SFML multimedia library.
+//
+//  PROGRAMMER :
+//               Martín Josemaría <martin.vuelta@gmail.com>
+//
+//               * Software Development and Research
+//                 SoftButterfly
+//                 Lima - Peru
+//
+//               * Faculty of Physical Science
+//                 Universidad Nacional Mayor de San Marcos
+//                 Lima - Peru
+//
+//  FILE       :
+//               memory.hpp
+//
+//  DESCRIPTION:
+//               Per frame arena allocator for short lived lists (contacts,
+//               vertices, log records) and heap allocation counters.
+//
+//****************************************************************************80
+
+#ifndef GEOT_MEMORY_HPP
+#define GEOT_MEMORY_HPP
+
+#include <cstddef>
+
+#include <vector>
+
+
+//----------------------------------------------------------------------------80
+//  ARENA DEL CUADRO
+//----------------------------------------------------------------------------80
+// Reserva por desplazamiento de un puntero dentro de un bloque fijo. No se
+// libera memoria individualmente: reset() descarta todo lo asignado durante
+// el cuadro. Si el bloque se llena se recurre al heap (y se cuenta como
+// desborde) hasta el siguiente reset.
+class FrameArena {
+public:
+    explicit FrameArena(std::size_t capacity);
+    ~FrameArena();
+
+    void* allocate(std::size_t size, std::size_t alignment);
+    void reset();
+
+    std::size_t getCapacity() const;
+    std::size_t getUsed() const;
+    std::size_t getPeak() const;
+    unsigned long getOverflows() const;
+
+private:
+    FrameArena(const FrameArena&);
+    FrameArena& operator=(const FrameArena&);
+
+    // Bloques pedidos al heap cuando el bloque fijo se llena
+    struct Overflow {
+        Overflow* next;
+    };
+
+    char* buffer;
+    std::size_t capacity;
+    std::size_t used;
+    std::size_t peak;
+    unsigned long overflows;
+    Overflow* overflowBlocks;
+};
+
+
+//----------------------------------------------------------------------------80
+//  ASIGNADOR PARA CONTENEDORES
+//----------------------------------------------------------------------------80
+template <typename T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+
+    explicit ArenaAllocator(FrameArena& frameArena) : arena(&frameArena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.getArena()) {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(arena->allocate(n*sizeof(T), alignof(T)));
+    }
+
+    // La memoria se recupera al reiniciar la arena
+    void deallocate(T*, std::size_t) {}
+
+    FrameArena* getArena() const {
+        return arena;
+    }
+
+private:
+    FrameArena* arena;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+    return a.getArena() == b.getArena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+    return a.getArena() != b.getArena();
+}
+
+// Lista válida solo hasta el siguiente reset de la arena
+template <typename T>
+using FrameVector = std::vector<T, ArenaAllocator<T> >;
+
+
+//----------------------------------------------------------------------------80
+//  CONTADORES DEL HEAP
+//----------------------------------------------------------------------------80
+// Número de llamadas a operator new desde que inicia el programa, en todos los
+// hilos: también cuenta las del hilo de audio de SFML, del que escribe los
+// volcados del registro de tirones y de los hilos de los lotes y del
+// rasterizador
+unsigned long getHeapAllocations();
+
+#endif
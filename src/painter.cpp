@@ -0,0 +1,354 @@
+//****************************************************************************80
+//
+//  PROGRAM    :
+//               GeoT
+//
+//  PURPOSE    :
+//               Program to show Goemetric Transformations as an applied
+//               exploration SFML multimedia library.
+//
+//  PROGRAMMER :
+//               Martín Josemaría <martin.vuelta@gmail.com>
+//
+//               * Software Development and Research
+//                 SoftButterfly
+//                 Lima - Peru
+//
+//               * Faculty of Physical Science
+//                 Universidad Nacional Mayor de San Marcos
+//                 Lima - Peru
+//
+//  FILE       :
+//               painter.cpp
+//
+//  DESCRIPTION:
+//               Scene drawing shared by the window and the software
+//               renderer.
+//
+//****************************************************************************80
+
+#include "painter.hpp"
+
+
+// Nombre de cada transformación en el banner (NoEffect es la traslación)
+static const wchar_t* const labelNames[nEffects + 1] = {L"Traslación", L"Homotecia", L"Simetría", L"Rotación"};
+
+static const wchar_t* getLabelName(Effect effect) {
+    return labelNames[effect + 1];
+}
+
+static const wchar_t* const bannerTitle = L"Animación activa: ";
+
+// Tamaño de los textos del banner
+static const unsigned int bannerSize = 30;
+
+
+//----------------------------------------------------------------------------80
+//  ANIMACIONES
+//----------------------------------------------------------------------------80
+EffectAnimation::EffectAnimation() :
+    effect(NoEffect),
+    homoteticRadius(0.f),
+    rotation(0.f),
+    axisStart(0, 0),
+    axisEnd(0, 0)
+{
+}
+
+void EffectAnimation::reset(Effect newEffect, float ballRadius) {
+    effect = newEffect;
+    homoteticRadius = ballRadius;
+    axisStart = sf::Vector2f(0, 0);
+    axisEnd = sf::Vector2f(0, 0);
+}
+
+void EffectAnimation::advance(sf::Vector2f position) {
+    if (effect == Homothecy) {
+        homoteticRadius += 0.5f;
+
+        if (axisStart == sf::Vector2f(0, 0)) {
+            axisStart = position;
+        }
+        axisEnd = position;
+    }
+
+    if (effect == Rotation) {
+        rotation += 5.f;
+    }
+}
+
+Effect EffectAnimation::getEffect() const {
+    return effect;
+}
+
+float EffectAnimation::getHomoteticRadius() const {
+    return homoteticRadius;
+}
+
+float EffectAnimation::getRotation() const {
+    return rotation;
+}
+
+sf::Vector2f EffectAnimation::getAxisStart() const {
+    return axisStart;
+}
+
+sf::Vector2f EffectAnimation::getAxisEnd() const {
+    return axisEnd;
+}
+
+
+//----------------------------------------------------------------------------80
+//  LIENZOS
+//----------------------------------------------------------------------------80
+SceneCanvas::~SceneCanvas() {
+}
+
+WindowCanvas::WindowCanvas(sf::RenderTarget& renderTarget, const SceneStyle& style, const sf::Font& font,
+                           const sf::Texture& ballTexture, const sf::Texture& bricks,
+                           const sf::Texture& flagTexture, const sf::Texture& grassTexture) :
+    target(renderTarget),
+    brickTexture(bricks)
+{
+    field.setTexture(&grassTexture);
+    flag.setTexture(&flagTexture);
+
+    ball.setFillColor(style.foreground);
+    ball.setTexture(&ballTexture);
+
+    title.setFont(font);
+    title.setCharacterSize(bannerSize);
+    title.setFillColor(style.foreground);
+    title.setString(bannerTitle);
+
+    float bannerHeight = style.windowSize.y - style.panelSize.y;
+    title.setPosition(10, 0.5f*(bannerHeight - title.getLocalBounds().height));
+
+    // Todas las etiquetas en la posición que le corresponde a "Traslación"
+    sf::Text label;
+    label.setFont(font);
+    label.setCharacterSize(bannerSize);
+    label.setStyle(sf::Text::Bold);
+    label.setFillColor(style.highlight);
+    label.setString(getLabelName(NoEffect));
+    label.setPosition(30 + title.getLocalBounds().left + title.getLocalBounds().width, 0.5f*(bannerHeight - label.getLocalBounds().height));
+
+    for (int effect = 0; effect < nEffects + 1; effect++) {
+        labels[static_cast<std::size_t>(effect)] = label;
+        labels[static_cast<std::size_t>(effect)].setString(labelNames[effect]);
+    }
+
+    // Precarga de los caracteres del banner
+    std::vector<const sf::Text*> texts(1, &title);
+
+    for (const auto& text: labels) {
+        texts.push_back(&text);
+    }
+
+    prewarmTexts(texts);
+}
+
+void WindowCanvas::clear(sf::Color color) {
+    target.clear(color);
+}
+
+void WindowCanvas::drawRectangle(const sf::FloatRect& area, sf::Color color) {
+    rectangle.setPosition(area.left, area.top);
+    rectangle.setSize(sf::Vector2f(area.width, area.height));
+    rectangle.setFillColor(color);
+    target.draw(rectangle);
+}
+
+void WindowCanvas::drawField(const sf::FloatRect& area) {
+    field.setPosition(area.left, area.top);
+    field.setSize(sf::Vector2f(area.width, area.height));
+    target.draw(field);
+}
+
+void WindowCanvas::drawFlag(const sf::FloatRect& area) {
+    // La textura se repite, no se estira
+    flag.setPosition(area.left, area.top);
+    flag.setSize(sf::Vector2f(area.width, area.height));
+    flag.setTextureRect(sf::IntRect(0, 0, static_cast<int>(area.width), static_cast<int>(area.height)));
+    target.draw(flag);
+}
+
+void WindowCanvas::drawObstacle(sf::Vector2f center, sf::Vector2f size) {
+    const sf::Vector2f brickSize(brickTexture.getSize());
+    sf::Vector2f half = 0.5f*size;
+
+    quads.push_back(sf::Vertex(sf::Vector2f(center.x - half.x, center.y - half.y), sf::Vector2f(0.f, 0.f)));
+    quads.push_back(sf::Vertex(sf::Vector2f(center.x + half.x, center.y - half.y), sf::Vector2f(brickSize.x, 0.f)));
+    quads.push_back(sf::Vertex(sf::Vector2f(center.x + half.x, center.y + half.y), sf::Vector2f(brickSize.x, brickSize.y)));
+    quads.push_back(sf::Vertex(sf::Vector2f(center.x - half.x, center.y + half.y), sf::Vector2f(0.f, brickSize.y)));
+}
+
+void WindowCanvas::endObstacles() {
+    if (!quads.empty()) {
+        target.draw(&quads[0], quads.size(), sf::Quads, &brickTexture);
+        quads.clear();
+    }
+}
+
+void WindowCanvas::drawBall(sf::Vector2f center, float radius, float rotation) {
+    if (ball.getRadius() != radius) {
+        ball.setRadius(radius);
+        ball.setOrigin(radius, radius);
+    }
+
+    ball.setPosition(center);
+    ball.setRotation(rotation);
+    target.draw(ball);
+}
+
+void WindowCanvas::drawDisk(sf::Vector2f center, float radius, sf::Color color) {
+    disk.setRadius(radius);
+    disk.setOrigin(radius, radius);
+    disk.setPosition(center);
+    disk.setFillColor(color);
+    target.draw(disk);
+}
+
+void WindowCanvas::drawLine(sf::Vector2f start, sf::Vector2f end, sf::Color color) {
+    sf::Vertex line[2] = {sf::Vertex(start, color), sf::Vertex(end, color)};
+    target.draw(line, 2, sf::Lines);
+}
+
+void WindowCanvas::drawBanner(Effect effect) {
+    target.draw(title);
+    target.draw(labels[static_cast<std::size_t>(effect + 1)]);
+}
+
+RasterCanvas::RasterCanvas(Rasterizer& target, const SceneStyle& style, GlyphFont& glyphFont,
+                           const sf::Image& ball, const sf::Image& brick,
+                           const sf::Image& flag, const sf::Image& grass) :
+    rasterizer(target),
+    font(glyphFont),
+    foreground(style.foreground),
+    highlight(style.highlight),
+    ballImage(ball),
+    brickImage(brick),
+    flagImage(flag),
+    grassImage(grass)
+{
+    // Mismas posiciones que los textos de la ventana
+    float bannerHeight = style.windowSize.y - style.panelSize.y;
+    sf::FloatRect titleBounds = font.getBounds(bannerTitle, bannerSize, false);
+    sf::FloatRect labelBounds = font.getBounds(getLabelName(NoEffect), bannerSize, false);
+
+    titlePosition = sf::Vector2f(10, 0.5f*(bannerHeight - titleBounds.height));
+    labelPosition = sf::Vector2f(30 + titleBounds.left + titleBounds.width, 0.5f*(bannerHeight - labelBounds.height));
+}
+
+void RasterCanvas::clear(sf::Color color) {
+    rasterizer.clear(color);
+}
+
+void RasterCanvas::drawRectangle(const sf::FloatRect& area, sf::Color color) {
+    rasterizer.drawRectangle(area, color);
+}
+
+void RasterCanvas::drawField(const sf::FloatRect& area) {
+    rasterizer.drawRectangle(area, sf::Color::White, &grassImage);
+}
+
+void RasterCanvas::drawFlag(const sf::FloatRect& area) {
+    rasterizer.drawRectangle(area, sf::Color::White, &flagImage, sf::IntRect(0, 0, static_cast<int>(area.width), static_cast<int>(area.height)));
+}
+
+void RasterCanvas::drawObstacle(sf::Vector2f center, sf::Vector2f size) {
+    sf::Vector2f half = 0.5f*size;
+    rasterizer.drawRectangle(sf::FloatRect(center.x - half.x, center.y - half.y, size.x, size.y), sf::Color::White, &brickImage);
+}
+
+void RasterCanvas::endObstacles() {
+}
+
+void RasterCanvas::drawBall(sf::Vector2f center, float radius, float rotation) {
+    rasterizer.drawCircle(center, radius, foreground, &ballImage, rotation);
+}
+
+void RasterCanvas::drawDisk(sf::Vector2f center, float radius, sf::Color color) {
+    rasterizer.drawCircle(center, radius, color);
+}
+
+void RasterCanvas::drawLine(sf::Vector2f start, sf::Vector2f end, sf::Color color) {
+    rasterizer.drawLine(start, end, color);
+}
+
+void RasterCanvas::drawBanner(Effect effect) {
+    rasterizer.drawText(font, bannerTitle, titlePosition, bannerSize, false, foreground);
+    rasterizer.drawText(font, getLabelName(effect), labelPosition, bannerSize, true, highlight);
+}
+
+
+//----------------------------------------------------------------------------80
+//  FUNCIONES
+//----------------------------------------------------------------------------80
+void paintScene(SceneCanvas& canvas, const SceneStyle& style, const Simulation& simulation, const EffectAnimation& animation, bool animated) {
+    const sf::Vector2f& window = style.windowSize;
+    const sf::Vector2f& panel = style.panelSize;
+    const float top = window.y - panel.y;
+
+    const float radius = simulation.getBallRadius();
+    const sf::Vector2f obstacleSize = simulation.getObstacleSize();
+    const sf::Vector2f position = simulation.getBall(0).position;
+    const Effect effect = animation.getEffect();
+
+    canvas.clear(style.background);
+    canvas.drawField(sf::FloatRect(0, top, panel.x, panel.y));
+
+    if (animated && effect == Homothecy) {
+        canvas.drawDisk(position, animation.getHomoteticRadius(), style.foreground);
+    }
+
+    // Panel del reflejo con los obstáculos reflejados
+    canvas.drawField(sf::FloatRect(panel.x, top, panel.x, panel.y));
+    canvas.drawRectangle(sf::FloatRect(panel.x - style.separatorWidth/2.f, top, style.separatorWidth, panel.y), style.background);
+
+    for (std::size_t i = 0; i < simulation.getObstacleCount(); i++) {
+        const sf::Vector2f& obstacle = simulation.getObstacle(i);
+        canvas.drawObstacle(sf::Vector2f(window.x - obstacle.x, obstacle.y), obstacleSize);
+    }
+
+    canvas.endObstacles();
+
+    // Las transformaciones se aplican solo a la primera pelota
+    for (std::size_t i = 1; i < simulation.getBallCount(); i++) {
+        canvas.drawBall(simulation.getBall(i).position, radius, 0.f);
+    }
+
+    canvas.drawBall(position, radius, animation.getRotation());
+
+    if (animated && effect == Homothecy) {
+        canvas.drawLine(animation.getAxisStart(), animation.getAxisEnd(), style.highlight);
+    }
+
+    for (std::size_t i = 0; i < simulation.getObstacleCount(); i++) {
+        canvas.drawObstacle(simulation.getObstacle(i), obstacleSize);
+    }
+
+    canvas.endObstacles();
+
+    if (animated && effect == Symmetry) {
+        canvas.drawBall(sf::Vector2f(window.x - position.x, position.y), radius, animation.getRotation());
+    }
+
+    // Banner encima de los paneles
+    canvas.drawFlag(sf::FloatRect(0, 0, window.x, top));
+    canvas.drawRectangle(sf::FloatRect(0, top - style.separatorWidth, window.x, style.separatorWidth), style.background);
+    canvas.drawBanner(effect);
+}
+
+void prewarmTexts(const std::vector<const sf::Text*>& texts) {
+    // getLocalBounds obliga a SFML a rasterizar los caracteres de cada texto
+    // en la página de su tamaño y estilo. Cuando una página crece la geometría
+    // de los textos ya construidos queda invalidada, por eso se recorren dos
+    // veces: en la segunda todos los caracteres ya existen y solo se
+    // reconstruye la geometría.
+    for (int pass = 0; pass < 2; pass++) {
+        for (const sf::Text* text: texts) {
+            text->getLocalBounds();
+        }
+    }
+}
@@ -0,0 +1,216 @@
+//****************************************************************************80
+//
+//  PROGRAM    :
+//               GeoT
+//
+//  PURPOSE    :
+//               Program to show Goemetric Transformations as an applied
+//               exploration SFML multimedia library.
+//
+//  PROGRAMMER :
+//               Martín Josemaría <martin.vuelta@gmail.com>
+//
+//               * Software Development and Research
+//                 SoftButterfly
+//                 Lima - Peru
+//
+//               * Faculty of Physical Science
+//                 Universidad Nacional Mayor de San Marcos
+//                 Lima - Peru
+//
+//  FILE       :
+//               painter.hpp
+//
+//  DESCRIPTION:
+//               Scene drawing shared by the window and the software
+//               renderer: draw order, animation state of the geometric
+//               transformations and the banner.
+//
+//****************************************************************************80
+
+#ifndef GEOT_PAINTER_HPP
+#define GEOT_PAINTER_HPP
+
+#include <SFML/Graphics.hpp>
+
+#include "raster.hpp"
+#include "simulation.hpp"
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+
+//----------------------------------------------------------------------------80
+//  TIPOS
+//----------------------------------------------------------------------------80
+// Medidas y colores de la pantalla. El panel de juego ocupa la parte inferior
+// izquierda y su reflejo la inferior derecha, el banner va encima.
+struct SceneStyle {
+    sf::Vector2f windowSize;
+    sf::Vector2f panelSize;
+    float separatorWidth;
+
+    // Fondo y separadores, pelotas y título, eje y transformación activa
+    sf::Color background;
+    sf::Color foreground;
+    sf::Color highlight;
+};
+
+
+//----------------------------------------------------------------------------80
+//  ANIMACIONES
+//----------------------------------------------------------------------------80
+// Estado de la transformación activa: el círculo de la homotecia crece medio
+// pixel por cuadro y deja un eje desde donde empezó, la rotación gira la
+// pelota 5 grados por cuadro.
+class EffectAnimation {
+public:
+    EffectAnimation();
+
+    // Nueva transformación (después de un choque, al retroceder o al cargar
+    // otra escena)
+    void reset(Effect effect, float ballRadius);
+
+    // Un cuadro de la animación con la pelota en position
+    void advance(sf::Vector2f position);
+
+    Effect getEffect() const;
+    float getHomoteticRadius() const;
+    float getRotation() const;
+    sf::Vector2f getAxisStart() const;
+    sf::Vector2f getAxisEnd() const;
+
+private:
+    Effect effect;
+    float homoteticRadius;
+    float rotation;
+    sf::Vector2f axisStart;
+    sf::Vector2f axisEnd;
+};
+
+
+//----------------------------------------------------------------------------80
+//  LIENZOS
+//----------------------------------------------------------------------------80
+// Destino del dibujo de la escena. Cada lienzo guarda sus texturas y textos,
+// paintScene decide qué se dibuja y en qué orden.
+class SceneCanvas {
+public:
+    virtual ~SceneCanvas();
+
+    virtual void clear(sf::Color color) = 0;
+
+    // Rectángulo de un solo color (separadores)
+    virtual void drawRectangle(const sf::FloatRect& area, sf::Color color) = 0;
+
+    // Césped de los paneles y bandera del banner
+    virtual void drawField(const sf::FloatRect& area) = 0;
+    virtual void drawFlag(const sf::FloatRect& area) = 0;
+
+    // Los obstáculos se pueden acumular hasta endObstacles
+    virtual void drawObstacle(sf::Vector2f center, sf::Vector2f size) = 0;
+    virtual void endObstacles() = 0;
+
+    // Pelota con textura girada rotation grados y círculo sin textura
+    virtual void drawBall(sf::Vector2f center, float radius, float rotation) = 0;
+    virtual void drawDisk(sf::Vector2f center, float radius, sf::Color color) = 0;
+
+    virtual void drawLine(sf::Vector2f start, sf::Vector2f end, sf::Color color) = 0;
+
+    // Título del banner y nombre de la transformación
+    virtual void drawBanner(Effect effect) = 0;
+};
+
+// Ventana de SFML (texturas y textos en la GPU). Los obstáculos se dibujan
+// en una sola llamada como una lista de cuadriláteros.
+class WindowCanvas : public SceneCanvas {
+public:
+    WindowCanvas(sf::RenderTarget& target, const SceneStyle& style, const sf::Font& font,
+                 const sf::Texture& ballTexture, const sf::Texture& brickTexture,
+                 const sf::Texture& flagTexture, const sf::Texture& grassTexture);
+
+    virtual void clear(sf::Color color);
+    virtual void drawRectangle(const sf::FloatRect& area, sf::Color color);
+    virtual void drawField(const sf::FloatRect& area);
+    virtual void drawFlag(const sf::FloatRect& area);
+    virtual void drawObstacle(sf::Vector2f center, sf::Vector2f size);
+    virtual void endObstacles();
+    virtual void drawBall(sf::Vector2f center, float radius, float rotation);
+    virtual void drawDisk(sf::Vector2f center, float radius, sf::Color color);
+    virtual void drawLine(sf::Vector2f start, sf::Vector2f end, sf::Color color);
+    virtual void drawBanner(Effect effect);
+
+private:
+    WindowCanvas(const WindowCanvas&);
+    WindowCanvas& operator=(const WindowCanvas&);
+
+    sf::RenderTarget& target;
+    const sf::Texture& brickTexture;
+
+    sf::RectangleShape rectangle;
+    sf::RectangleShape field;
+    sf::RectangleShape flag;
+    sf::CircleShape ball;
+    sf::CircleShape disk;
+
+    // Cuadriláteros pendientes, la capacidad se conserva entre cuadros
+    std::vector<sf::Vertex> quads;
+
+    // Una etiqueta ya construida por transformación (NoEffect incluido), al
+    // cambiar de transformación solo cambia cuál se dibuja
+    sf::Text title;
+    std::array<sf::Text, nEffects + 1> labels;
+};
+
+// Rasterizador por software (imágenes en memoria, sin OpenGL)
+class RasterCanvas : public SceneCanvas {
+public:
+    RasterCanvas(Rasterizer& rasterizer, const SceneStyle& style, GlyphFont& font,
+                 const sf::Image& ballImage, const sf::Image& brickImage,
+                 const sf::Image& flagImage, const sf::Image& grassImage);
+
+    virtual void clear(sf::Color color);
+    virtual void drawRectangle(const sf::FloatRect& area, sf::Color color);
+    virtual void drawField(const sf::FloatRect& area);
+    virtual void drawFlag(const sf::FloatRect& area);
+    virtual void drawObstacle(sf::Vector2f center, sf::Vector2f size);
+    virtual void endObstacles();
+    virtual void drawBall(sf::Vector2f center, float radius, float rotation);
+    virtual void drawDisk(sf::Vector2f center, float radius, sf::Color color);
+    virtual void drawLine(sf::Vector2f start, sf::Vector2f end, sf::Color color);
+    virtual void drawBanner(Effect effect);
+
+private:
+    RasterCanvas(const RasterCanvas&);
+    RasterCanvas& operator=(const RasterCanvas&);
+
+    Rasterizer& rasterizer;
+    GlyphFont& font;
+    sf::Color foreground;
+    sf::Color highlight;
+
+    const sf::Image& ballImage;
+    const sf::Image& brickImage;
+    const sf::Image& flagImage;
+    const sf::Image& grassImage;
+
+    sf::Vector2f titlePosition;
+    sf::Vector2f labelPosition;
+};
+
+
+//----------------------------------------------------------------------------80
+//  FUNCIONES
+//----------------------------------------------------------------------------80
+// Dibuja la escena completa en el mismo orden en la ventana y por software.
+// Con animated igual a false (pausa) no se dibujan el círculo y el eje de la
+// homotecia ni el reflejo de la simetría.
+void paintScene(SceneCanvas& canvas, const SceneStyle& style, const Simulation& simulation, const EffectAnimation& animation, bool animated);
+
+// Rasteriza de antemano los caracteres de los textos, así no hay pausas al
+// mostrar un texto por primera vez. Los textos que comparten tamaño deben
+// precargarse en la misma llamada.
+void prewarmTexts(const std::vector<const sf::Text*>& texts);
+
+#endif
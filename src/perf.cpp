@@ -0,0 +1,290 @@
+//****************************************************************************80
+//
+//  PROGRAM    :
+//               GeoT
+//
+//  PURPOSE    :
+//               Program to show Goemetric Transformations as an applied
+//               exploration SFML multimedia library.
+//
+//  PROGRAMMER :
+//               Martín Josemaría <martin.vuelta@gmail.com>
+//
+//               * Software Development and Research
+//                 SoftButterfly
+//                 Lima - Peru
+//
+//               * Faculty of Physical Science
+//                 Universidad Nacional Mayor de San Marcos
+//                 Lima - Peru
+//
+//  FILE       :
+//               perf.cpp
+//
+//  DESCRIPTION:
+//               Hardware performance counters for the main loop phases.
+//
+//****************************************************************************80
+
+#include "perf.hpp"
+
+#include <cstring>
+
+#include <iomanip>
+#include <iostream>
+
+#if defined(__linux__)
+    #include <unistd.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <linux/perf_event.h>
+#endif
+
+
+static const char* phaseNames[nPhases] = {"events", "physics", "draw", "display"};
+static const char* counterNames[nCounters] = {"cycles", "instructions", "cache-misses", "branch-misses"};
+
+const char* getPhaseName(Phase phase) {
+    return phaseNames[phase];
+}
+
+#if defined(__linux__)
+static int openCounter(unsigned long long config, int group) {
+    struct perf_event_attr attributes;
+
+    std::memset(&attributes, 0, sizeof(attributes));
+    attributes.size = sizeof(attributes);
+    attributes.type = PERF_TYPE_HARDWARE;
+    attributes.config = config;
+    attributes.disabled = (group == -1) ? 1 : 0;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    attributes.read_format = PERF_FORMAT_GROUP;
+
+    return static_cast<int>(syscall(__NR_perf_event_open, &attributes, 0, -1, group, 0));
+}
+#endif
+
+
+//----------------------------------------------------------------------------80
+//  CONTADORES
+//----------------------------------------------------------------------------80
+PerfCounters::PerfCounters() :
+    enabled(false),
+    leader(-1),
+    nSlots(0),
+    frames(0)
+{
+    for (int i = 0; i < nCounters; i++) {
+        descriptors[i] = -1;
+        slots[i] = -1;
+        phaseCounters[i] = 0;
+    }
+
+    std::memset(frame, 0, sizeof(frame));
+    std::memset(total, 0, sizeof(total));
+}
+
+PerfCounters::~PerfCounters() {
+    #if defined(__linux__)
+        for (int i = 0; i < nCounters; i++) {
+            if (descriptors[i] >= 0) {
+                close(descriptors[i]);
+            }
+        }
+    #endif
+}
+
+void PerfCounters::enable() {
+    enabled = true;
+
+    #if defined(__linux__)
+        const unsigned long long configs[nCounters] = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_MISSES
+        };
+
+        for (int i = 0; i < nCounters; i++) {
+            descriptors[i] = openCounter(configs[i], leader);
+
+            if (descriptors[i] < 0) {
+                continue;
+            }
+
+            if (leader < 0) {
+                leader = descriptors[i];
+            }
+
+            slots[i] = nSlots++;
+        }
+
+        if (leader >= 0) {
+            ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+    #endif
+
+    if (nSlots < nCounters) {
+        std::cerr << "perf: ";
+        for (int i = 0; i < nCounters; i++) {
+            if (slots[i] < 0) {
+                std::cerr << counterNames[i] << " ";
+            }
+        }
+        std::cerr << "unavailable" << std::endl;
+    }
+}
+
+bool PerfCounters::isEnabled() const {
+    return enabled;
+}
+
+bool PerfCounters::hasCounter(Counter counter) const {
+    return slots[counter] >= 0;
+}
+
+bool PerfCounters::read(unsigned long long values[nCounters]) const {
+    #if defined(__linux__)
+        if (leader < 0) {
+            return false;
+        }
+
+        // Formato del grupo: número de contadores seguido de sus valores
+        unsigned long long buffer[1 + nCounters];
+        ssize_t length = ::read(leader, buffer, sizeof(buffer));
+
+        if (length < static_cast<ssize_t>(sizeof(unsigned long long)*static_cast<unsigned long>(1 + nSlots))) {
+            return false;
+        }
+
+        for (int i = 0; i < nCounters; i++) {
+            values[i] = (slots[i] >= 0) ? buffer[1 + slots[i]] : 0;
+        }
+
+        return true;
+    #else
+        (void) values;
+        return false;
+    #endif
+}
+
+void PerfCounters::begin(Phase) {
+    if (!enabled) {
+        return;
+    }
+
+    read(phaseCounters);
+    phaseStart = std::chrono::steady_clock::now();
+}
+
+void PerfCounters::end(Phase phase) {
+    if (!enabled) {
+        return;
+    }
+
+    std::chrono::steady_clock::time_point phaseEnd = std::chrono::steady_clock::now();
+    unsigned long long values[nCounters];
+
+    frame[phase].seconds += std::chrono::duration<double>(phaseEnd - phaseStart).count();
+
+    if (read(values)) {
+        for (int i = 0; i < nCounters; i++) {
+            frame[phase].counters[i] += values[i] - phaseCounters[i];
+        }
+    }
+}
+
+void PerfCounters::endFrame() {
+    if (!enabled) {
+        return;
+    }
+
+    for (int phase = 0; phase < nPhases; phase++) {
+        total[phase].seconds += frame[phase].seconds;
+
+        for (int i = 0; i < nCounters; i++) {
+            total[phase].counters[i] += frame[phase].counters[i];
+        }
+    }
+
+    std::memset(frame, 0, sizeof(frame));
+    frames++;
+}
+
+const PhaseSample& PerfCounters::getFrame(Phase phase) const {
+    return frame[phase];
+}
+
+const PhaseSample& PerfCounters::getTotal(Phase phase) const {
+    return total[phase];
+}
+
+unsigned long PerfCounters::getFrames() const {
+    return frames;
+}
+
+void PerfCounters::printFrame(std::ostream& output, bool header) const {
+    if (header) {
+        output << "frame";
+        for (int phase = 0; phase < nPhases; phase++) {
+            output << "," << phaseNames[phase] << "-seconds";
+            for (int i = 0; i < nCounters; i++) {
+                if (slots[i] >= 0) {
+                    output << "," << phaseNames[phase] << "-" << counterNames[i];
+                }
+            }
+        }
+        output << "\n";
+    }
+
+    output << frames;
+    for (int phase = 0; phase < nPhases; phase++) {
+        output << "," << frame[phase].seconds;
+        for (int i = 0; i < nCounters; i++) {
+            if (slots[i] >= 0) {
+                output << "," << frame[phase].counters[i];
+            }
+        }
+    }
+    output << "\n";
+}
+
+void PerfCounters::printTotals(std::ostream& output) const {
+    double n = frames > 0 ? static_cast<double>(frames) : 1.0;
+
+    output << "frames: " << frames << std::endl;
+    output << std::setw(8) << "phase" << std::setw(14) << "ms/frame";
+    for (int i = 0; i < nCounters; i++) {
+        output << std::setw(16) << counterNames[i];
+    }
+    output << std::setw(8) << "IPC" << std::endl;
+
+    for (int phase = 0; phase < nPhases; phase++) {
+        const PhaseSample& sample = total[phase];
+
+        output << std::setw(8) << phaseNames[phase] << std::setw(14) << 1000.0*sample.seconds/n;
+
+        // Totales de cada contador
+        for (int i = 0; i < nCounters; i++) {
+            if (slots[i] >= 0) {
+                output << std::setw(16) << sample.counters[i];
+            }
+            else {
+                output << std::setw(16) << "-";
+            }
+        }
+
+        if (slots[CyclesCounter] >= 0 && slots[InstructionsCounter] >= 0 && sample.counters[CyclesCounter] > 0) {
+            output << std::setw(8) << std::setprecision(3)
+                   << static_cast<double>(sample.counters[InstructionsCounter]) / static_cast<double>(sample.counters[CyclesCounter])
+                   << std::setprecision(6);
+        }
+        else {
+            output << std::setw(8) << "-";
+        }
+
+        output << std::endl;
+    }
+}
@@ -0,0 +1,123 @@
+//****************************************************************************80
+//
+//  PROGRAM    :
+//               GeoT
+//
+//  PURPOSE    :
+//               Program to show Goemetric Transformations as an applied
+//               exploration SFML multimedia library.
+//
+//  PROGRAMMER :
+//               Martín Josemaría <martin.vuelta@gmail.com>
+//
+//               * Software Development and Research
+//                 SoftButterfly
+//                 Lima - Peru
+//
+//               * Faculty of Physical Science
+//                 Universidad Nacional Mayor de San Marcos
+//                 Lima - Peru
+//
+//  FILE       :
+//               perf.hpp
+//
+//  DESCRIPTION:
+//               Hardware performance counters (perf_event_open) and timings
+//               for each phase of the main loop.
+//
+//****************************************************************************80
+
+#ifndef GEOT_PERF_HPP
+#define GEOT_PERF_HPP
+
+#include <chrono>
+#include <ostream>
+
+
+//----------------------------------------------------------------------------80
+//  TIPOS
+//----------------------------------------------------------------------------80
+// Fases del bucle principal
+enum Phase {
+    EventsPhase,
+    PhysicsPhase,
+    DrawPhase,
+    DisplayPhase,
+    nPhases
+};
+
+enum Counter {
+    CyclesCounter,
+    InstructionsCounter,
+    CacheMissesCounter,
+    BranchMissesCounter,
+    nCounters
+};
+
+// Nombre corto de la fase ("events", "physics", ...)
+const char* getPhaseName(Phase phase);
+
+struct PhaseSample {
+    double seconds;
+    unsigned long long counters[nCounters];
+};
+
+
+//----------------------------------------------------------------------------80
+//  CONTADORES
+//----------------------------------------------------------------------------80
+// Los cuatro contadores se abren como un grupo para leerlos con una sola
+// llamada al inicio y al final de cada fase. Si el sistema no permite usar
+// perf (otro sistema operativo, contenedores, perf_event_paranoid) o algún
+// contador no existe en el procesador, solo se reportan los tiempos y los
+// contadores que sí se pudieron abrir.
+class PerfCounters {
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    // Sin llamar a enable las mediciones no hacen nada
+    void enable();
+    bool isEnabled() const;
+    bool hasCounter(Counter counter) const;
+
+    void begin(Phase phase);
+    void end(Phase phase);
+
+    // Suma el cuadro actual a los totales y empieza uno nuevo
+    void endFrame();
+
+    const PhaseSample& getFrame(Phase phase) const;
+    const PhaseSample& getTotal(Phase phase) const;
+    unsigned long getFrames() const;
+
+    // Una línea CSV con el cuadro actual, antes de endFrame (con cabecera si
+    // header es verdadero)
+    void printFrame(std::ostream& output, bool header) const;
+    void printTotals(std::ostream& output) const;
+
+private:
+    PerfCounters(const PerfCounters&);
+    PerfCounters& operator=(const PerfCounters&);
+
+    bool read(unsigned long long values[nCounters]) const;
+
+    bool enabled;
+
+    // Descriptor del líder del grupo y de cada contador (-1 si no existe)
+    int leader;
+    int descriptors[nCounters];
+
+    // Posición de cada contador en la lectura del grupo
+    int slots[nCounters];
+    int nSlots;
+
+    std::chrono::steady_clock::time_point phaseStart;
+    unsigned long long phaseCounters[nCounters];
+
+    PhaseSample frame[nPhases];
+    PhaseSample total[nPhases];
+    unsigned long frames;
+};
+
+#endif
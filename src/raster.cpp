@@ -0,0 +1,772 @@
+//****************************************************************************80
+//
+//  PROGRAM    :
+//               GeoT
+//
+//  PURPOSE    :
+//               Program to show Goemetric Transformations as an applied
+//               exploration SFML multimedia library.
+//
+//  PROGRAMMER :
+//               Martín Josemaría <martin.vuelta@gmail.com>
+//
+//               * Software Development and Research
+//                 SoftButterfly
+//                 Lima - Peru
+//
+//               * Faculty of Physical Science
+//                 Universidad Nacional Mayor de San Marcos
+//                 Lima - Peru
+//
+//  FILE       :
+//               raster.cpp
+//
+//  DESCRIPTION:
+//               CPU software rasterizer and FreeType glyph cache.
+//
+//****************************************************************************80
+
+#include "raster.hpp"
+
+#include <cmath>
+#include <cstring>
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <thread>
+
+// Con GEOT_NO_FREETYPE (Windows sin FREETYPEDIR) no se cargan fuentes
+#if !defined(GEOT_NO_FREETYPE)
+    #include <ft2build.h>
+    #include FT_FREETYPE_H
+    #include FT_OUTLINE_H
+#endif
+
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
+
+
+// Lado de los bloques en pixeles
+static const int tileSize = 64;
+
+
+//----------------------------------------------------------------------------80
+//  COLORES
+//----------------------------------------------------------------------------80
+// Los pixeles se guardan como bytes R, G, B, A en memoria (el mismo orden de
+// sf::Image). El alfa del color de origen solo indica cuánto se mezcla, el
+// resultado siempre es opaco.
+static std::uint32_t pack(std::uint8_t r, std::uint8_t g, std::uint8_t b, std::uint8_t a) {
+    std::uint8_t bytes[4] = {r, g, b, a};
+    std::uint32_t pixel;
+
+    std::memcpy(&pixel, bytes, sizeof(pixel));
+
+    return pixel;
+}
+
+static std::uint32_t pack(sf::Color color) {
+    return pack(color.r, color.g, color.b, color.a);
+}
+
+// x/255 redondeado, exacto para x en [0, 255*255]
+static unsigned int div255(unsigned int x) {
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+static std::uint8_t mul255(unsigned int a, unsigned int b) {
+    return static_cast<std::uint8_t>(div255(a*b));
+}
+
+static std::uint8_t toCoverage(float coverage) {
+    if (coverage <= 0.f) {
+        return 0;
+    }
+
+    if (coverage >= 1.f) {
+        return 255;
+    }
+
+    return static_cast<std::uint8_t>(coverage*255.f + 0.5f);
+}
+
+// Rellena n pixeles con el mismo color
+static void fillSpan(std::uint32_t* destination, std::size_t n, std::uint32_t color) {
+    std::size_t i = 0;
+
+    #if defined(__SSE2__)
+        __m128i value = _mm_set1_epi32(static_cast<int>(color));
+
+        for (; i + 4 <= n; i += 4) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), value);
+        }
+    #endif
+
+    for (; i < n; i++) {
+        destination[i] = color;
+    }
+}
+
+// Mezcla n pixeles de source sobre destination usando el alfa de source
+static void blendSpan(std::uint32_t* destination, const std::uint32_t* source, std::size_t n) {
+    std::size_t i = 0;
+
+    #if defined(__SSE2__)
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i opaque = _mm_set1_epi32(static_cast<int>(pack(0, 0, 0, 255)));
+        const __m128i full = _mm_set1_epi16(255);
+        const __m128i half = _mm_set1_epi16(128);
+
+        for (; i + 4 <= n; i += 4) {
+            __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+            __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(destination + i));
+
+            // Alfa de cada pixel repetido en sus cuatro canales de 16 bits
+            __m128i alpha = _mm_srli_epi32(s, 24);
+            alpha = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 16));
+            __m128i alphaLow = _mm_unpacklo_epi32(alpha, alpha);
+            __m128i alphaHigh = _mm_unpackhi_epi32(alpha, alpha);
+
+            s = _mm_or_si128(s, opaque);
+
+            __m128i low = _mm_add_epi16(
+                _mm_mullo_epi16(_mm_unpacklo_epi8(s, zero), alphaLow),
+                _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_sub_epi16(full, alphaLow)));
+            __m128i high = _mm_add_epi16(
+                _mm_mullo_epi16(_mm_unpackhi_epi8(s, zero), alphaHigh),
+                _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_sub_epi16(full, alphaHigh)));
+
+            // div255 en cada canal
+            low = _mm_add_epi16(low, half);
+            low = _mm_srli_epi16(_mm_add_epi16(low, _mm_srli_epi16(low, 8)), 8);
+            high = _mm_add_epi16(high, half);
+            high = _mm_srli_epi16(_mm_add_epi16(high, _mm_srli_epi16(high, 8)), 8);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_packus_epi16(low, high));
+        }
+    #endif
+
+    for (; i < n; i++) {
+        std::uint8_t s[4];
+        std::uint8_t d[4];
+
+        std::memcpy(s, source + i, 4);
+        std::memcpy(d, destination + i, 4);
+
+        unsigned int alpha = s[3];
+        s[3] = 255;
+
+        for (int c = 0; c < 4; c++) {
+            d[c] = static_cast<std::uint8_t>(div255(s[c]*alpha + d[c]*(255 - alpha)));
+        }
+
+        std::memcpy(destination + i, d, 4);
+    }
+}
+
+// Texel (x, y) de la imagen multiplicado por color, con el alfa multiplicado
+// además por coverage
+static std::uint32_t shade(const sf::Image& image, unsigned int x, unsigned int y, sf::Color color, std::uint8_t coverage) {
+    const std::uint8_t* texel = image.getPixelsPtr() + 4*(static_cast<std::size_t>(y)*image.getSize().x + x);
+
+    return pack(mul255(texel[0], color.r), mul255(texel[1], color.g), mul255(texel[2], color.b),
+                mul255(mul255(texel[3], color.a), coverage));
+}
+
+static int wrap(int value, int size) {
+    value %= size;
+    return value < 0 ? value + size : value;
+}
+
+
+//----------------------------------------------------------------------------80
+//  FUENTES
+//----------------------------------------------------------------------------80
+GlyphFont::GlyphFont() :
+    library(NULL),
+    face(NULL),
+    currentSize(0)
+{
+}
+
+#if defined(GEOT_NO_FREETYPE)
+// Sin FreeType ninguna fuente se puede cargar y los caracteres quedan vacíos
+GlyphFont::~GlyphFont() {
+}
+
+bool GlyphFont::loadFromFile(const std::string& filename) {
+    std::cerr << "Failed to load font \"" << filename << "\" (built without FreeType)" << std::endl;
+    return false;
+}
+
+bool GlyphFont::setSize(unsigned int) {
+    return false;
+}
+
+const GlyphBitmap& GlyphFont::getGlyph(std::uint32_t, unsigned int, bool) {
+    static const GlyphBitmap empty = {0, 0, 0, 0, 0.f, std::vector<std::uint8_t>()};
+    return empty;
+}
+
+float GlyphFont::getKerning(std::uint32_t, std::uint32_t, unsigned int) {
+    return 0.f;
+}
+#else
+GlyphFont::~GlyphFont() {
+    if (face != NULL) {
+        FT_Done_Face(face);
+    }
+
+    if (library != NULL) {
+        FT_Done_FreeType(library);
+    }
+}
+
+bool GlyphFont::loadFromFile(const std::string& filename) {
+    if (library == NULL && FT_Init_FreeType(&library) != 0) {
+        library = NULL;
+        std::cerr << "Failed to load font \"" << filename << "\" (failed to initialize FreeType)" << std::endl;
+        return false;
+    }
+
+    FT_Face loaded;
+
+    if (FT_New_Face(library, filename.c_str(), 0, &loaded) != 0) {
+        std::cerr << "Failed to load font \"" << filename << "\" (failed to create the font face)" << std::endl;
+        return false;
+    }
+
+    if (FT_Select_Charmap(loaded, FT_ENCODING_UNICODE) != 0) {
+        std::cerr << "Failed to load font \"" << filename << "\" (failed to set the Unicode character set)" << std::endl;
+        FT_Done_Face(loaded);
+        return false;
+    }
+
+    if (face != NULL) {
+        FT_Done_Face(face);
+    }
+
+    face = loaded;
+    currentSize = 0;
+    glyphs.clear();
+
+    return true;
+}
+
+bool GlyphFont::setSize(unsigned int characterSize) {
+    if (characterSize == currentSize) {
+        return true;
+    }
+
+    if (FT_Set_Pixel_Sizes(face, 0, characterSize) != 0) {
+        return false;
+    }
+
+    currentSize = characterSize;
+
+    return true;
+}
+
+const GlyphBitmap& GlyphFont::getGlyph(std::uint32_t codePoint, unsigned int characterSize, bool bold) {
+    std::uint64_t key = (static_cast<std::uint64_t>(bold ? 1 : 0) << 63) | (static_cast<std::uint64_t>(characterSize) << 32) | codePoint;
+    std::map<std::uint64_t, GlyphBitmap>::iterator found = glyphs.find(key);
+
+    if (found != glyphs.end()) {
+        return found->second;
+    }
+
+    GlyphBitmap& glyph = glyphs[key];
+
+    glyph.left = 0;
+    glyph.top = 0;
+    glyph.width = 0;
+    glyph.height = 0;
+    glyph.advance = 0.f;
+
+    if (face == NULL || !setSize(characterSize) || FT_Load_Char(face, codePoint, FT_LOAD_TARGET_NORMAL | FT_LOAD_FORCE_AUTOHINT) != 0) {
+        return glyph;
+    }
+
+    // Mismo grosor extra que sf::Font para el estilo negrita
+    const FT_Pos weight = 1 << 6;
+    FT_GlyphSlot slot = face->glyph;
+
+    if (bold && slot->format == FT_GLYPH_FORMAT_OUTLINE) {
+        FT_Outline_Embolden(&slot->outline, weight);
+    }
+
+    if (FT_Render_Glyph(slot, FT_RENDER_MODE_NORMAL) != 0) {
+        return glyph;
+    }
+
+    glyph.advance = static_cast<float>(slot->metrics.horiAdvance) / 64.f;
+
+    if (bold) {
+        glyph.advance += static_cast<float>(weight) / 64.f;
+    }
+
+    const FT_Bitmap& bitmap = slot->bitmap;
+
+    glyph.left = slot->bitmap_left;
+    glyph.top = -slot->bitmap_top;
+    glyph.width = static_cast<int>(bitmap.width);
+    glyph.height = static_cast<int>(bitmap.rows);
+    glyph.coverage.resize(static_cast<std::size_t>(glyph.width)*static_cast<std::size_t>(glyph.height));
+
+    for (int y = 0; y < glyph.height; y++) {
+        const unsigned char* source = bitmap.buffer + y*bitmap.pitch;
+
+        if (bitmap.pixel_mode == FT_PIXEL_MODE_MONO) {
+            for (int x = 0; x < glyph.width; x++) {
+                glyph.coverage[static_cast<std::size_t>(y*glyph.width + x)] = ((source[x/8] >> (7 - x%8)) & 1) ? 255 : 0;
+            }
+        }
+        else {
+            std::copy(source, source + glyph.width, glyph.coverage.begin() + y*glyph.width);
+        }
+    }
+
+    return glyph;
+}
+
+float GlyphFont::getKerning(std::uint32_t first, std::uint32_t second, unsigned int characterSize) {
+    if (face == NULL || !FT_HAS_KERNING(face) || !setSize(characterSize)) {
+        return 0.f;
+    }
+
+    FT_Vector kerning;
+
+    if (FT_Get_Kerning(face, FT_Get_Char_Index(face, first), FT_Get_Char_Index(face, second), FT_KERNING_DEFAULT, &kerning) != 0) {
+        return 0.f;
+    }
+
+    return static_cast<float>(kerning.x) / 64.f;
+}
+#endif
+
+sf::FloatRect GlyphFont::getBounds(const sf::String& string, unsigned int characterSize, bool bold) {
+    float x = 0.f;
+    float left = 0.f;
+    float top = 0.f;
+    float right = 0.f;
+    float bottom = 0.f;
+    bool empty = true;
+
+    for (std::size_t i = 0; i < string.getSize(); i++) {
+        if (i > 0) {
+            x += getKerning(string[i - 1], string[i], characterSize);
+        }
+
+        const GlyphBitmap& glyph = getGlyph(string[i], characterSize, bold);
+
+        if (glyph.width > 0 && glyph.height > 0) {
+            float glyphLeft = x + static_cast<float>(glyph.left);
+            float glyphTop = static_cast<float>(characterSize) + static_cast<float>(glyph.top);
+
+            if (empty) {
+                left = glyphLeft;
+                top = glyphTop;
+                right = glyphLeft;
+                bottom = glyphTop;
+                empty = false;
+            }
+
+            left = std::min(left, glyphLeft);
+            top = std::min(top, glyphTop);
+            right = std::max(right, glyphLeft + static_cast<float>(glyph.width));
+            bottom = std::max(bottom, glyphTop + static_cast<float>(glyph.height));
+        }
+
+        x += glyph.advance;
+    }
+
+    return sf::FloatRect(left, top, right - left, bottom - top);
+}
+
+
+//----------------------------------------------------------------------------80
+//  RASTERIZADOR
+//----------------------------------------------------------------------------80
+Rasterizer::Rasterizer(unsigned int frameWidth, unsigned int frameHeight, unsigned int threads) :
+    width(frameWidth),
+    height(frameHeight),
+    nThreads(threads > 0 ? threads : std::max(1U, std::thread::hardware_concurrency())),
+    tilesX((frameWidth + tileSize - 1) / tileSize),
+    tilesY((frameHeight + tileSize - 1) / tileSize),
+    pixels(static_cast<std::size_t>(frameWidth)*frameHeight, pack(0, 0, 0, 255)),
+    bins(static_cast<std::size_t>(tilesX)*tilesY),
+    rows(nThreads, std::vector<std::uint32_t>(tileSize)),
+    nextTile(0),
+    generation(0),
+    busy(0),
+    stopping(false)
+{
+    // No hacen falta más hilos que bloques
+    unsigned int nWorkers = static_cast<unsigned int>(std::min<std::size_t>(nThreads, bins.size()));
+
+    for (unsigned int id = 1; id < nWorkers; id++) {
+        workers.push_back(std::thread(&Rasterizer::work, this, id));
+    }
+}
+
+Rasterizer::~Rasterizer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    wake.notify_all();
+
+    for (auto& worker: workers) {
+        worker.join();
+    }
+}
+
+void Rasterizer::work(unsigned int id) {
+    unsigned long seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+
+    for (;;) {
+        wake.wait(lock, [&]() { return generation != seen || stopping; });
+
+        if (stopping) {
+            break;
+        }
+
+        seen = generation;
+        lock.unlock();
+
+        rasterizeTiles(id);
+
+        lock.lock();
+
+        if (--busy == 0) {
+            done.notify_one();
+        }
+    }
+}
+
+void Rasterizer::rasterizeTiles(unsigned int id) {
+    // Los hilos toman el siguiente bloque libre
+    for (std::size_t tile = nextTile.fetch_add(1); tile < bins.size(); tile = nextTile.fetch_add(1)) {
+        rasterize(tile, rows[id]);
+    }
+}
+
+void Rasterizer::push(const Command& command) {
+    int x0 = std::max(command.x0, 0);
+    int y0 = std::max(command.y0, 0);
+    int x1 = std::min(command.x1, static_cast<int>(width));
+    int y1 = std::min(command.y1, static_cast<int>(height));
+
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+
+    std::uint32_t index = static_cast<std::uint32_t>(commands.size());
+    commands.push_back(command);
+
+    for (int ty = y0/tileSize; ty <= (y1 - 1)/tileSize; ty++) {
+        for (int tx = x0/tileSize; tx <= (x1 - 1)/tileSize; tx++) {
+            bins[static_cast<std::size_t>(ty)*tilesX + static_cast<std::size_t>(tx)].push_back(index);
+        }
+    }
+}
+
+void Rasterizer::clear(sf::Color color) {
+    // Todo lo registrado antes queda cubierto
+    commands.clear();
+
+    for (auto& bin: bins) {
+        bin.clear();
+    }
+
+    Command command = Command();
+    command.type = ClearCommand;
+    command.color = sf::Color(color.r, color.g, color.b, 255);
+    command.x0 = 0;
+    command.y0 = 0;
+    command.x1 = static_cast<int>(width);
+    command.y1 = static_cast<int>(height);
+
+    push(command);
+}
+
+void Rasterizer::drawRectangle(sf::FloatRect rectangle, sf::Color color, const sf::Image* texture, sf::IntRect textureRect) {
+    Command command = Command();
+    command.type = RectangleCommand;
+    command.color = color;
+
+    // Pixeles cuyo centro está dentro del rectángulo
+    command.x0 = static_cast<int>(std::ceil(rectangle.left - 0.5f));
+    command.y0 = static_cast<int>(std::ceil(rectangle.top - 0.5f));
+    command.x1 = static_cast<int>(std::ceil(rectangle.left + rectangle.width - 0.5f));
+    command.y1 = static_cast<int>(std::ceil(rectangle.top + rectangle.height - 0.5f));
+
+    command.a[0] = rectangle.left;
+    command.a[1] = rectangle.top;
+    command.a[2] = rectangle.width;
+    command.a[3] = rectangle.height;
+
+    if (texture != NULL && texture->getSize().x > 0 && texture->getSize().y > 0) {
+        command.texture = texture;
+
+        // Sin rectángulo se usa la textura completa
+        if (textureRect.width == 0 || textureRect.height == 0) {
+            textureRect = sf::IntRect(0, 0, static_cast<int>(texture->getSize().x), static_cast<int>(texture->getSize().y));
+        }
+
+        command.textureRect = textureRect;
+    }
+
+    push(command);
+}
+
+void Rasterizer::drawCircle(sf::Vector2f center, float radius, sf::Color color, const sf::Image* texture, float rotation) {
+    const float degrees = 3.14159265358979f/180.f;
+
+    Command command = Command();
+    command.type = CircleCommand;
+    command.color = color;
+
+    command.x0 = static_cast<int>(std::floor(center.x - radius - 1.f));
+    command.y0 = static_cast<int>(std::floor(center.y - radius - 1.f));
+    command.x1 = static_cast<int>(std::ceil(center.x + radius + 1.f));
+    command.y1 = static_cast<int>(std::ceil(center.y + radius + 1.f));
+
+    command.a[0] = center.x;
+    command.a[1] = center.y;
+    command.a[2] = radius;
+    command.a[3] = std::cos(rotation*degrees);
+    command.a[4] = std::sin(rotation*degrees);
+
+    if (texture != NULL && texture->getSize().x > 0 && texture->getSize().y > 0) {
+        command.texture = texture;
+    }
+
+    push(command);
+}
+
+void Rasterizer::drawLine(sf::Vector2f first, sf::Vector2f second, sf::Color color) {
+    Command command = Command();
+    command.type = LineCommand;
+    command.color = color;
+
+    command.x0 = static_cast<int>(std::floor(std::min(first.x, second.x) - 1.f));
+    command.y0 = static_cast<int>(std::floor(std::min(first.y, second.y) - 1.f));
+    command.x1 = static_cast<int>(std::ceil(std::max(first.x, second.x) + 1.f));
+    command.y1 = static_cast<int>(std::ceil(std::max(first.y, second.y) + 1.f));
+
+    command.a[0] = first.x;
+    command.a[1] = first.y;
+    command.a[2] = second.x;
+    command.a[3] = second.y;
+
+    push(command);
+}
+
+void Rasterizer::drawText(GlyphFont& font, const sf::String& string, sf::Vector2f position, unsigned int characterSize, bool bold, sf::Color color) {
+    float x = position.x;
+    int baseline = static_cast<int>(std::floor(position.y + static_cast<float>(characterSize) + 0.5f));
+
+    for (std::size_t i = 0; i < string.getSize(); i++) {
+        if (i > 0) {
+            x += font.getKerning(string[i - 1], string[i], characterSize);
+        }
+
+        const GlyphBitmap& glyph = font.getGlyph(string[i], characterSize, bold);
+
+        if (glyph.width > 0 && glyph.height > 0) {
+            Command command = Command();
+            command.type = GlyphCommand;
+            command.color = color;
+            command.x0 = static_cast<int>(std::floor(x + 0.5f)) + glyph.left;
+            command.y0 = baseline + glyph.top;
+            command.x1 = command.x0 + glyph.width;
+            command.y1 = command.y0 + glyph.height;
+            command.a[0] = static_cast<float>(command.x0);
+            command.a[1] = static_cast<float>(command.y0);
+            command.glyph = &glyph;
+
+            push(command);
+        }
+
+        x += glyph.advance;
+    }
+}
+
+void Rasterizer::flush() {
+    nextTile = 0;
+
+    if (!workers.empty()) {
+        std::lock_guard<std::mutex> lock(mutex);
+        busy = static_cast<unsigned int>(workers.size());
+        generation++;
+    }
+
+    wake.notify_all();
+    rasterizeTiles(0);
+
+    if (!workers.empty()) {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this]() { return busy == 0; });
+    }
+
+    // Los comandos ya no se necesitan, el siguiente cuadro empieza vacío
+    commands.clear();
+
+    for (auto& bin: bins) {
+        bin.clear();
+    }
+}
+
+void Rasterizer::rasterize(std::size_t tile, std::vector<std::uint32_t>& row) {
+    int tileX0 = static_cast<int>(tile % tilesX)*tileSize;
+    int tileY0 = static_cast<int>(tile / tilesX)*tileSize;
+    int tileX1 = std::min(tileX0 + tileSize, static_cast<int>(width));
+    int tileY1 = std::min(tileY0 + tileSize, static_cast<int>(height));
+
+    for (std::uint32_t index: bins[tile]) {
+        const Command& command = commands[index];
+
+        int x0 = std::max(command.x0, tileX0);
+        int x1 = std::min(command.x1, tileX1);
+        int y0 = std::max(command.y0, tileY0);
+        int y1 = std::min(command.y1, tileY1);
+
+        for (int y = y0; y < y1; y++) {
+            drawRow(command, y, x0, x1, row);
+        }
+    }
+}
+
+// Pixeles [x0, x1) de la fila y
+void Rasterizer::drawRow(const Command& command, int y, int x0, int x1, std::vector<std::uint32_t>& row) {
+    std::uint32_t* destination = &pixels[static_cast<std::size_t>(y)*width + static_cast<std::size_t>(x0)];
+    std::size_t n = static_cast<std::size_t>(x1 - x0);
+
+    const sf::Color& color = command.color;
+
+    float py = static_cast<float>(y) + 0.5f;
+
+    switch (command.type) {
+        case ClearCommand:
+            fillSpan(destination, n, pack(color));
+            return;
+
+        case RectangleCommand:
+            if (command.texture == NULL) {
+                if (color.a == 255) {
+                    fillSpan(destination, n, pack(color));
+                }
+                else {
+                    std::fill(row.begin(), row.begin() + static_cast<std::ptrdiff_t>(n), pack(color));
+                    blendSpan(destination, &row[0], n);
+                }
+                return;
+            }
+            else {
+                const sf::Image& texture = *command.texture;
+                const sf::IntRect& rect = command.textureRect;
+                int textureWidth = static_cast<int>(texture.getSize().x);
+                int textureHeight = static_cast<int>(texture.getSize().y);
+
+                float v = (py - command.a[1]) / command.a[3];
+                int ty = wrap(rect.top + static_cast<int>(std::floor(v*static_cast<float>(rect.height))), textureHeight);
+
+                for (int x = x0; x < x1; x++) {
+                    float u = (static_cast<float>(x) + 0.5f - command.a[0]) / command.a[2];
+                    int tx = wrap(rect.left + static_cast<int>(std::floor(u*static_cast<float>(rect.width))), textureWidth);
+
+                    row[static_cast<std::size_t>(x - x0)] = shade(texture, static_cast<unsigned int>(tx), static_cast<unsigned int>(ty), color, 255);
+                }
+            }
+            break;
+
+        case CircleCommand: {
+            float radius = command.a[2];
+            float dy = py - command.a[1];
+
+            for (int x = x0; x < x1; x++) {
+                float dx = static_cast<float>(x) + 0.5f - command.a[0];
+                std::uint8_t coverage = toCoverage(radius + 0.5f - std::sqrt(dx*dx + dy*dy));
+                std::uint32_t& pixel = row[static_cast<std::size_t>(x - x0)];
+
+                if (command.texture == NULL) {
+                    pixel = pack(color.r, color.g, color.b, mul255(color.a, coverage));
+                    continue;
+                }
+
+                // Punto en la textura: se deshace la rotación de la figura
+                const sf::Image& texture = *command.texture;
+                float localX = (command.a[3]*dx + command.a[4]*dy + radius) / (2.f*radius);
+                float localY = (command.a[3]*dy - command.a[4]*dx + radius) / (2.f*radius);
+
+                int tx = static_cast<int>(std::floor(localX*static_cast<float>(texture.getSize().x)));
+                int ty = static_cast<int>(std::floor(localY*static_cast<float>(texture.getSize().y)));
+
+                tx = std::max(0, std::min(tx, static_cast<int>(texture.getSize().x) - 1));
+                ty = std::max(0, std::min(ty, static_cast<int>(texture.getSize().y) - 1));
+
+                pixel = shade(texture, static_cast<unsigned int>(tx), static_cast<unsigned int>(ty), color, coverage);
+            }
+            break;
+        }
+
+        case LineCommand: {
+            float ax = command.a[0];
+            float ay = command.a[1];
+            float bx = command.a[2] - ax;
+            float by = command.a[3] - ay;
+            float length = bx*bx + by*by;
+
+            for (int x = x0; x < x1; x++) {
+                float px = static_cast<float>(x) + 0.5f - ax;
+                float qy = py - ay;
+
+                // Distancia del centro del pixel al segmento
+                float t = length > 0.f ? std::max(0.f, std::min(1.f, (px*bx + qy*by) / length)) : 0.f;
+                float ex = px - t*bx;
+                float ey = qy - t*by;
+                std::uint8_t coverage = toCoverage(1.f - std::sqrt(ex*ex + ey*ey));
+
+                row[static_cast<std::size_t>(x - x0)] = pack(color.r, color.g, color.b, mul255(color.a, coverage));
+            }
+            break;
+        }
+
+        case GlyphCommand: {
+            const GlyphBitmap& glyph = *command.glyph;
+            const std::uint8_t* coverage = &glyph.coverage[static_cast<std::size_t>((y - command.y0)*glyph.width + (x0 - command.x0))];
+
+            for (std::size_t i = 0; i < n; i++) {
+                row[i] = pack(color.r, color.g, color.b, mul255(color.a, coverage[i]));
+            }
+            break;
+        }
+
+        default:
+            return;
+    }
+
+    blendSpan(destination, &row[0], n);
+}
+
+unsigned int Rasterizer::getWidth() const {
+    return width;
+}
+
+unsigned int Rasterizer::getHeight() const {
+    return height;
+}
+
+const std::uint8_t* Rasterizer::getPixels() const {
+    return reinterpret_cast<const std::uint8_t*>(pixels.data());
+}
+
+void Rasterizer::copyToImage(sf::Image& image) const {
+    image.create(width, height, getPixels());
+}
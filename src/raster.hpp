@@ -0,0 +1,215 @@
+//****************************************************************************80
+//
+//  PROGRAM    :
+//               GeoT
+//
+//  PURPOSE    :
+//               Program to show Goemetric Transformations as an applied
+//               exploration SFML multimedia library.
+//
+//  PROGRAMMER :
+//               Martín Josemaría <martin.vuelta@gmail.com>
+//
+//               * Software Development and Research
+//                 SoftButterfly
+//                 Lima - Peru
+//
+//               * Faculty of Physical Science
+//                 Universidad Nacional Mayor de San Marcos
+//                 Lima - Peru
+//
+//  FILE       :
+//               raster.hpp
+//
+//  DESCRIPTION:
+//               CPU software rasterizer to render frames without a GL
+//               context (golden images for regression tests and frame
+//               export).
+//
+//****************************************************************************80
+
+#ifndef GEOT_RASTER_HPP
+#define GEOT_RASTER_HPP
+
+#include <SFML/Graphics.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+// Tipos de FreeType, solo se usan en raster.cpp
+struct FT_LibraryRec_;
+struct FT_FaceRec_;
+
+
+//----------------------------------------------------------------------------80
+//  TIPOS
+//----------------------------------------------------------------------------80
+// Carácter rasterizado: cobertura de 8 bits por pixel. left y top son el
+// desplazamiento de la esquina superior izquierda respecto al punto de la
+// línea base donde empieza el carácter.
+struct GlyphBitmap {
+    int left;
+    int top;
+    int width;
+    int height;
+    float advance;
+    std::vector<std::uint8_t> coverage;
+};
+
+
+//----------------------------------------------------------------------------80
+//  FUENTES
+//----------------------------------------------------------------------------80
+// Fuente TrueType cargada con FreeType. A diferencia de sf::Font no guarda
+// los caracteres en una textura, así que no necesita un contexto de OpenGL.
+// Los caracteres se rasterizan la primera vez que se piden y se guardan por
+// tamaño y estilo.
+class GlyphFont {
+public:
+    GlyphFont();
+    ~GlyphFont();
+
+    bool loadFromFile(const std::string& filename);
+
+    const GlyphBitmap& getGlyph(std::uint32_t codePoint, unsigned int characterSize, bool bold);
+    float getKerning(std::uint32_t first, std::uint32_t second, unsigned int characterSize);
+
+    // Rectángulo que ocupa el texto con su origen en (0, 0), como
+    // sf::Text::getLocalBounds
+    sf::FloatRect getBounds(const sf::String& string, unsigned int characterSize, bool bold);
+
+private:
+    GlyphFont(const GlyphFont&);
+    GlyphFont& operator=(const GlyphFont&);
+
+    bool setSize(unsigned int characterSize);
+
+    FT_LibraryRec_* library;
+    FT_FaceRec_* face;
+    unsigned int currentSize;
+
+    std::map<std::uint64_t, GlyphBitmap> glyphs;
+};
+
+
+//----------------------------------------------------------------------------80
+//  RASTERIZADOR
+//----------------------------------------------------------------------------80
+// Las llamadas de dibujo solo se registran. flush() reparte los comandos
+// entre bloques de tileSize x tileSize pixeles y los hilos rasterizan bloques
+// completos, cada uno en el orden en que se registraron los comandos. Cada
+// pixel pertenece a un solo bloque, así que el resultado es idéntico con
+// cualquier número de hilos. Los hilos se crean una sola vez con el
+// rasterizador y esperan entre un cuadro y el siguiente.
+//
+// Los colores se mezclan con aritmética entera (SSE2 cuando está disponible,
+// con el mismo redondeo que el código escalar), las imágenes son
+// reproducibles pixel a pixel.
+class Rasterizer {
+public:
+    // Con threads igual a cero se usa un hilo por núcleo
+    Rasterizer(unsigned int width, unsigned int height, unsigned int threads);
+    ~Rasterizer();
+
+    void clear(sf::Color color);
+
+    // Rectángulo alineado a los ejes con textura (opcional). textureRect se
+    // repite si sale de la textura. El color multiplica a la textura.
+    void drawRectangle(sf::FloatRect rectangle, sf::Color color, const sf::Image* texture = NULL, sf::IntRect textureRect = sf::IntRect());
+
+    // Círculo con borde suavizado y textura (opcional) girada rotation grados
+    void drawCircle(sf::Vector2f center, float radius, sf::Color color, const sf::Image* texture = NULL, float rotation = 0.f);
+
+    // Línea de un pixel de ancho con bordes suavizados
+    void drawLine(sf::Vector2f first, sf::Vector2f second, sf::Color color);
+
+    // Texto con la primera línea a characterSize pixeles de position, como
+    // sf::Text
+    void drawText(GlyphFont& font, const sf::String& string, sf::Vector2f position, unsigned int characterSize, bool bold, sf::Color color);
+
+    // Rasteriza todos los comandos registrados
+    void flush();
+
+    unsigned int getWidth() const;
+    unsigned int getHeight() const;
+
+    // Pixeles RGBA de 8 bits, fila por fila (después de flush)
+    const std::uint8_t* getPixels() const;
+
+    void copyToImage(sf::Image& image) const;
+
+private:
+    enum CommandType {
+        ClearCommand,
+        RectangleCommand,
+        CircleCommand,
+        LineCommand,
+        GlyphCommand
+    };
+
+    struct Command {
+        CommandType type;
+        sf::Color color;
+
+        // Pixeles que puede tocar el comando: [x0, x1) x [y0, y1)
+        int x0;
+        int y0;
+        int x1;
+        int y1;
+
+        // Rectángulo: posición y tamaño. Círculo: centro, radio y
+        // rotación (coseno y seno). Línea: extremos. Carácter: posición.
+        float a[6];
+
+        const sf::Image* texture;
+        sf::IntRect textureRect;
+        const GlyphBitmap* glyph;
+    };
+
+    Rasterizer(const Rasterizer&);
+    Rasterizer& operator=(const Rasterizer&);
+
+    void push(const Command& command);
+    void work(unsigned int id);
+    void rasterizeTiles(unsigned int id);
+    void rasterize(std::size_t tile, std::vector<std::uint32_t>& row);
+    void drawRow(const Command& command, int y, int x0, int x1, std::vector<std::uint32_t>& row);
+
+    unsigned int width;
+    unsigned int height;
+    unsigned int nThreads;
+    unsigned int tilesX;
+    unsigned int tilesY;
+
+    std::vector<std::uint32_t> pixels;
+    std::vector<Command> commands;
+
+    // Comandos que tocan cada bloque
+    std::vector<std::vector<std::uint32_t> > bins;
+
+    // Fila de trabajo de cada hilo (colores de los pixeles a mezclar)
+    std::vector<std::vector<std::uint32_t> > rows;
+
+    // Hilos de trabajo (el hilo que llama a flush es el número 0). Cada
+    // flush incrementa generation y espera a que busy vuelva a cero.
+    std::vector<std::thread> workers;
+    std::atomic<std::size_t> nextTile;
+    unsigned long generation;
+    unsigned int busy;
+    bool stopping;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+};
+
+#endif
@@ -0,0 +1,481 @@
+//****************************************************************************80
+//
+//  PROGRAM    :
+//               GeoT
+//
+//  PURPOSE    :
+//               Program to show Goemetric Transformations as an applied
+//               exploration SFML multimedia library.
+//
+//  PROGRAMMER :
+//               Martín Josemaría <martin.vuelta@gmail.com>
+//
+//               * Software Development and Research
+//                 SoftButterfly
+//                 Lima - Peru
+//
+//               * Faculty of Physical Science
+//                 Universidad Nacional Mayor de San Marcos
+//                 Lima - Peru
+//
+//  FILE       :
+//               scene.cpp
+//
+//  DESCRIPTION:
+//               Scene loading (text and memory mapped binary) and hot reload.
+//
+//****************************************************************************80
+
+#include "scene.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include <fstream>
+#include <sstream>
+#include <utility>
+#include <iostream>
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__TOS_WIN__)
+    #define GEOT_SCENE_NO_MMAP
+#elif defined(unix) || defined(__unix) || defined(__unix__) || defined(__APPLE__)
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #if defined(__linux__)
+        #include <sys/inotify.h>
+    #endif
+#else
+    #error Unsupported or unknown operating system
+#endif
+
+
+//----------------------------------------------------------------------------80
+//  VALIDACIÓN
+//----------------------------------------------------------------------------80
+static bool isPositive(float value) {
+    return std::isfinite(value) && value > 0.f;
+}
+
+// Valores que la simulación puede usar sin problemas
+static bool isValid(const SceneHeader& header, const sf::Vector2f* obstacles) {
+    if (header.nBalls == 0 || header.nBalls > SceneMaxBalls) {
+        return false;
+    }
+
+    if (!isPositive(header.obstacleWidth) || !isPositive(header.obstacleHeight) || !isPositive(header.ballRadius) ||
+        !std::isfinite(header.ballSpeed) || header.ballSpeed < 0.f
+    ) {
+        return false;
+    }
+
+    for (std::uint32_t i = 0; i < header.nObstacles; i++) {
+        if (!std::isfinite(obstacles[i].x) || !std::isfinite(obstacles[i].y)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+//----------------------------------------------------------------------------80
+//  ESCENA
+//----------------------------------------------------------------------------80
+Scene::Scene() :
+    mappedObstacles(NULL),
+    mapping(NULL),
+    mappingSize(0)
+{
+    std::memcpy(header.magic, SceneMagic, sizeof(header.magic));
+    header.version = SceneVersion;
+    header.nObstacles = 0;
+    header.nBalls = 1;
+    header.obstacleWidth = 60.f;
+    header.obstacleHeight = 60.f;
+    header.ballRadius = 20.f;
+    header.ballSpeed = 150.f;
+}
+
+Scene::~Scene() {
+    unmap();
+}
+
+void Scene::unmap() {
+    #if !defined(GEOT_SCENE_NO_MMAP)
+        if (mapping != NULL) {
+            munmap(mapping, mappingSize);
+        }
+    #endif
+
+    mapping = NULL;
+    mappingSize = 0;
+    mappedObstacles = NULL;
+}
+
+bool Scene::loadFromFile(const std::string& path) {
+    std::ifstream file(path.c_str(), std::ios::binary);
+    char magic[4] = {0, 0, 0, 0};
+
+    if (!file) {
+        std::cerr << "Failed to load scene \"" << path << "\"" << std::endl;
+        return false;
+    }
+
+    // Un archivo de texto puede ser más corto que la cabecera (vacío o solo
+    // comentarios)
+    bool isBinary = file.read(magic, sizeof(magic)) && std::memcmp(magic, SceneMagic, sizeof(magic)) == 0;
+    file.close();
+
+    if (isBinary) {
+        return loadFromBinary(path);
+    }
+
+    return loadFromText(path);
+}
+
+bool Scene::loadFromText(const std::string& path) {
+    std::ifstream file(path.c_str());
+
+    if (!file) {
+        std::cerr << "Failed to load scene \"" << path << "\"" << std::endl;
+        return false;
+    }
+
+    Scene scene;
+    std::string line;
+    int lineNumber = 0;
+
+    while (std::getline(file, line)) {
+        lineNumber++;
+
+        // Quitamos los comentarios
+        std::string::size_type comment = line.find('#');
+        if (comment != std::string::npos) {
+            line.erase(comment);
+        }
+
+        std::istringstream fields(line);
+        std::string key;
+
+        if (!(fields >> key)) {
+            continue;
+        }
+
+        bool valid = true;
+
+        if (key == "obstacle") {
+            sf::Vector2f position;
+            valid = static_cast<bool>(fields >> position.x >> position.y);
+            scene.obstacles.push_back(position);
+        }
+        else if (key == "obstacle_size") {
+            valid = static_cast<bool>(fields >> scene.header.obstacleWidth >> scene.header.obstacleHeight);
+        }
+        else if (key == "ball_radius") {
+            valid = static_cast<bool>(fields >> scene.header.ballRadius);
+        }
+        else if (key == "ball_speed") {
+            valid = static_cast<bool>(fields >> scene.header.ballSpeed);
+        }
+        else if (key == "balls") {
+            // Se lee con signo: "-1" no debe convertirse en 4294967295
+            long nBalls = 0;
+            valid = static_cast<bool>(fields >> nBalls) && nBalls > 0 && nBalls <= static_cast<long>(SceneMaxBalls);
+            scene.header.nBalls = static_cast<std::uint32_t>(nBalls);
+        }
+        else {
+            valid = false;
+        }
+
+        // Nada más después de los valores
+        valid = valid && (fields >> std::ws).eof();
+
+        if (!valid) {
+            std::cerr << "Failed to load scene \"" << path << "\" (line " << lineNumber << ")" << std::endl;
+            return false;
+        }
+    }
+
+    scene.header.nObstacles = static_cast<std::uint32_t>(scene.obstacles.size());
+
+    if (!isValid(scene.header, scene.getObstacles())) {
+        std::cerr << "Failed to load scene \"" << path << "\" (invalid values)" << std::endl;
+        return false;
+    }
+
+    swap(scene);
+
+    return true;
+}
+
+bool Scene::loadFromBinary(const std::string& path) {
+    Scene scene;
+
+    #if defined(GEOT_SCENE_NO_MMAP)
+        // Sin mmap leemos el archivo completo de una sola vez
+        std::ifstream file(path.c_str(), std::ios::binary);
+
+        if (!file.read(reinterpret_cast<char*>(&scene.header), sizeof(SceneHeader)) ||
+            std::memcmp(scene.header.magic, SceneMagic, sizeof(SceneMagic)) != 0 ||
+            scene.header.version != SceneVersion
+        ) {
+            std::cerr << "Failed to load scene \"" << path << "\" (bad header)" << std::endl;
+            return false;
+        }
+
+        // El número de obstáculos no puede pasar de lo que queda del archivo
+        std::streampos start = file.tellg();
+        file.seekg(0, std::ios::end);
+        std::streamoff remaining = file.tellg() - start;
+        file.seekg(start);
+
+        if (remaining < 0 || scene.header.nObstacles > static_cast<std::uint64_t>(remaining)/sizeof(sf::Vector2f)) {
+            std::cerr << "Failed to load scene \"" << path << "\" (truncated)" << std::endl;
+            return false;
+        }
+
+        scene.obstacles.resize(scene.header.nObstacles);
+
+        if (scene.header.nObstacles > 0 &&
+            !file.read(reinterpret_cast<char*>(&scene.obstacles[0]), static_cast<std::streamsize>(scene.header.nObstacles*sizeof(sf::Vector2f)))
+        ) {
+            std::cerr << "Failed to load scene \"" << path << "\" (truncated)" << std::endl;
+            return false;
+        }
+    #else
+        int fd = open(path.c_str(), O_RDONLY);
+        struct stat info;
+
+        if (fd < 0 || fstat(fd, &info) != 0) {
+            if (fd >= 0) {
+                close(fd);
+            }
+            std::cerr << "Failed to load scene \"" << path << "\"" << std::endl;
+            return false;
+        }
+
+        std::size_t size = static_cast<std::size_t>(info.st_size);
+
+        if (size < sizeof(SceneHeader)) {
+            close(fd);
+            std::cerr << "Failed to load scene \"" << path << "\" (bad header)" << std::endl;
+            return false;
+        }
+
+        void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+
+        if (data == MAP_FAILED) {
+            std::cerr << "Failed to load scene \"" << path << "\" (mmap)" << std::endl;
+            return false;
+        }
+
+        scene.mapping = data;
+        scene.mappingSize = size;
+
+        const SceneHeader* mappedHeader = static_cast<const SceneHeader*>(data);
+
+        if (std::memcmp(mappedHeader->magic, SceneMagic, sizeof(SceneMagic)) != 0 ||
+            mappedHeader->version != SceneVersion
+        ) {
+            std::cerr << "Failed to load scene \"" << path << "\" (bad header)" << std::endl;
+            return false;
+        }
+
+        // Sin multiplicar nObstacles, que podría desbordar
+        if (mappedHeader->nObstacles > (size - sizeof(SceneHeader))/sizeof(sf::Vector2f)) {
+            std::cerr << "Failed to load scene \"" << path << "\" (truncated)" << std::endl;
+            return false;
+        }
+
+        // Las posiciones se usan directamente desde el mapeo
+        scene.header = *mappedHeader;
+        scene.mappedObstacles = static_cast<const sf::Vector2f*>(static_cast<const void*>(mappedHeader + 1));
+    #endif
+
+    if (!isValid(scene.header, scene.getObstacles())) {
+        std::cerr << "Failed to load scene \"" << path << "\" (invalid values)" << std::endl;
+        return false;
+    }
+
+    swap(scene);
+
+    return true;
+}
+
+bool Scene::saveToText(const std::string& path) const {
+    std::ofstream file(path.c_str());
+
+    if (!file) {
+        std::cerr << "Failed to save scene \"" << path << "\"" << std::endl;
+        return false;
+    }
+
+    file << "# GeoT scene" << std::endl;
+    file << "obstacle_size " << header.obstacleWidth << " " << header.obstacleHeight << std::endl;
+    file << "ball_radius " << header.ballRadius << std::endl;
+    file << "ball_speed " << header.ballSpeed << std::endl;
+    file << "balls " << header.nBalls << std::endl;
+
+    const sf::Vector2f* positions = getObstacles();
+
+    for (std::size_t i = 0; i < getObstacleCount(); i++) {
+        file << "obstacle " << positions[i].x << " " << positions[i].y << "\n";
+    }
+
+    return static_cast<bool>(file);
+}
+
+bool Scene::saveToBinary(const std::string& path) const {
+    // Se escribe en un archivo temporal y luego se renombra: un proceso que
+    // tenga mapeada la versión anterior nunca ve el archivo a medio escribir.
+    std::string temporaryPath = path + ".tmp";
+    std::ofstream file(temporaryPath.c_str(), std::ios::binary);
+
+    if (!file) {
+        std::cerr << "Failed to save scene \"" << path << "\"" << std::endl;
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(SceneHeader));
+
+    if (getObstacleCount() > 0) {
+        file.write(reinterpret_cast<const char*>(getObstacles()), static_cast<std::streamsize>(getObstacleCount()*sizeof(sf::Vector2f)));
+    }
+
+    file.close();
+
+    #if defined(GEOT_SCENE_NO_MMAP)
+        std::remove(path.c_str());
+    #endif
+
+    if (!file || std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        std::remove(temporaryPath.c_str());
+        std::cerr << "Failed to save scene \"" << path << "\"" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+void Scene::setObstacles(const std::vector<sf::Vector2f>& positions) {
+    unmap();
+    obstacles = positions;
+    header.nObstacles = static_cast<std::uint32_t>(obstacles.size());
+}
+
+std::size_t Scene::getObstacleCount() const {
+    return header.nObstacles;
+}
+
+const sf::Vector2f* Scene::getObstacles() const {
+    if (mappedObstacles != NULL) {
+        return mappedObstacles;
+    }
+
+    return obstacles.empty() ? NULL : &obstacles[0];
+}
+
+sf::Vector2f Scene::getObstacleSize() const {
+    return sf::Vector2f(header.obstacleWidth, header.obstacleHeight);
+}
+
+float Scene::getBallRadius() const {
+    return header.ballRadius;
+}
+
+float Scene::getBallSpeed() const {
+    return header.ballSpeed;
+}
+
+unsigned int Scene::getBallCount() const {
+    return header.nBalls;
+}
+
+void Scene::swap(Scene& other) {
+    std::swap(header, other.header);
+    obstacles.swap(other.obstacles);
+    std::swap(mappedObstacles, other.mappedObstacles);
+    std::swap(mapping, other.mapping);
+    std::swap(mappingSize, other.mappingSize);
+}
+
+
+//----------------------------------------------------------------------------80
+//  RECARGA EN CALIENTE
+//----------------------------------------------------------------------------80
+SceneWatcher::SceneWatcher() :
+    fd(-1),
+    wd(-1)
+{
+}
+
+SceneWatcher::~SceneWatcher() {
+    #if defined(__linux__)
+        if (fd >= 0) {
+            close(fd);
+        }
+    #endif
+}
+
+bool SceneWatcher::watch(const std::string& path) {
+    #if defined(__linux__)
+        std::string directory = ".";
+        std::string::size_type separator = path.find_last_of('/');
+
+        fileName = path;
+
+        if (separator != std::string::npos) {
+            directory = path.substr(0, separator);
+            fileName = path.substr(separator + 1);
+        }
+
+        fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+        if (fd < 0) {
+            return false;
+        }
+
+        wd = inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+
+        return wd >= 0;
+    #else
+        (void) path;
+        return false;
+    #endif
+}
+
+bool SceneWatcher::isWatching() const {
+    return fd >= 0 && wd >= 0;
+}
+
+bool SceneWatcher::hasChanged() {
+    bool changed = false;
+
+    #if defined(__linux__)
+        if (fd < 0) {
+            return false;
+        }
+
+        // Alineado como inotify_event para poder recorrer el buffer
+        alignas(struct inotify_event) char buffer[4096];
+        ssize_t length;
+
+        while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+            for (char* p = buffer; p < buffer + length; ) {
+                const struct inotify_event* event = static_cast<const struct inotify_event*>(static_cast<const void*>(p));
+
+                if (event->len > 0 && fileName == event->name) {
+                    changed = true;
+                }
+
+                p += sizeof(struct inotify_event) + event->len;
+            }
+        }
+    #endif
+
+    return changed;
+}
@@ -0,0 +1,159 @@
+//****************************************************************************80
+//
+//  PROGRAM    :
+//               GeoT
+//
+//  PURPOSE    :
+//               Program to show Goemetric Transformations as an applied
+//               exploration SFML multimedia library.
+//
+//  PROGRAMMER :
+//               Martín Josemaría <martin.vuelta@gmail.com>
+//
+//               * Software Development and Research
+//                 SoftButterfly
+//                 Lima - Peru
+//
+//               * Faculty of Physical Science
+//                 Universidad Nacional Mayor de San Marcos
+//                 Lima - Peru
+//
+//  FILE       :
+//               scene.hpp
+//
+//  DESCRIPTION:
+//               Scene description (obstacle layout, sizes, ball count and
+//               speed) with a text format for authoring and a binary format
+//               that is memory mapped and used without parsing.
+//
+//****************************************************************************80
+
+#ifndef GEOT_SCENE_HPP
+#define GEOT_SCENE_HPP
+
+#include <SFML/System.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <string>
+#include <vector>
+
+
+//----------------------------------------------------------------------------80
+//  FORMATO BINARIO
+//----------------------------------------------------------------------------80
+// Cabecera del archivo binario. A continuación vienen nObstacles pares de
+// float (x, y) con la posición del centro de cada obstáculo relativa a la
+// esquina superior izquierda del panel. Todos los campos tienen 4 bytes, así
+// que las posiciones quedan alineadas y se leen directamente del mapeo.
+struct SceneHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t nObstacles;
+    std::uint32_t nBalls;
+    float obstacleWidth;
+    float obstacleHeight;
+    float ballRadius;
+    float ballSpeed;
+};
+
+const char SceneMagic[4] = {'G', 'E', 'O', 'T'};
+const std::uint32_t SceneVersion = 1;
+
+// Límite de pelotas al cargar, para que un archivo dañado no pida memoria sin
+// control. Los obstáculos no tienen límite: su número se compara con el tamaño
+// del archivo.
+const std::uint32_t SceneMaxBalls = 1024;
+
+
+//----------------------------------------------------------------------------80
+//  ESCENA
+//----------------------------------------------------------------------------80
+// Los valores por defecto son los de la escena original (sin obstáculos, se
+// agregan con setObstacles).
+//
+// Formato de texto (una directiva por línea, '#' inicia un comentario):
+//
+//     obstacle_size 60 60
+//     ball_radius   20
+//     ball_speed    150
+//     balls         1
+//     obstacle      133.3 183.3
+//     obstacle      ...
+//
+// Al cargar se rechazan los tamaños y radios no positivos, los valores no
+// finitos, las cantidades fuera de los límites y los campos sobrantes. Si la
+// carga falla la escena no cambia.
+class Scene {
+public:
+    Scene();
+    ~Scene();
+
+    // Carga desde archivo, binario o texto según la cabecera
+    bool loadFromFile(const std::string& path);
+    bool loadFromText(const std::string& path);
+    bool loadFromBinary(const std::string& path);
+
+    bool saveToText(const std::string& path) const;
+    bool saveToBinary(const std::string& path) const;
+
+    void setObstacles(const std::vector<sf::Vector2f>& positions);
+
+    std::size_t getObstacleCount() const;
+    const sf::Vector2f* getObstacles() const;
+
+    sf::Vector2f getObstacleSize() const;
+    float getBallRadius() const;
+    float getBallSpeed() const;
+    unsigned int getBallCount() const;
+
+    // Intercambio sin copias, usado por la recarga en caliente
+    void swap(Scene& other);
+
+private:
+    Scene(const Scene&);
+    Scene& operator=(const Scene&);
+
+    void unmap();
+
+    SceneHeader header;
+
+    // Posiciones propias (escena de texto o construida en código) ...
+    std::vector<sf::Vector2f> obstacles;
+
+    // ... o vista sobre el archivo binario mapeado en memoria
+    const sf::Vector2f* mappedObstacles;
+    void* mapping;
+    std::size_t mappingSize;
+};
+
+
+//----------------------------------------------------------------------------80
+//  RECARGA EN CALIENTE
+//----------------------------------------------------------------------------80
+// Vigila el archivo de escena con inotify. Se vigila el directorio y no el
+// archivo porque los editores suelen guardar escribiendo un archivo nuevo y
+// renombrándolo. En sistemas sin inotify hasChanged siempre es falso.
+class SceneWatcher {
+public:
+    SceneWatcher();
+    ~SceneWatcher();
+
+    bool watch(const std::string& path);
+
+    // No bloquea: indica si el archivo se escribió desde la última consulta
+    bool hasChanged();
+
+    bool isWatching() const;
+
+private:
+    SceneWatcher(const SceneWatcher&);
+    SceneWatcher& operator=(const SceneWatcher&);
+
+    int fd;
+    int wd;
+    std::string fileName;
+};
+
+#endif
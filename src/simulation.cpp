@@ -0,0 +1,594 @@
+//****************************************************************************80
+//
+//  PROGRAM    :
+//               GeoT
+//
+//  PURPOSE    :
+//               Program to show Goemetric Transformations as an applied
+//               exploration SFML multimedia library.
+//
+//  PROGRAMMER :
+//               Martín Josemaría <martin.vuelta@gmail.com>
+//
+//               * Software Development and Research
+//                 SoftButterfly
+//                 Lima - Peru
+//
+//               * Faculty of Physical Science
+//                 Universidad Nacional Mayor de San Marcos
+//                 Lima - Peru
+//
+//  FILE       :
+//               simulation.cpp
+//
+//  DESCRIPTION:
+//               Ball and obstacle physics.
+//
+//****************************************************************************80
+
+#include "simulation.hpp"
+
+#include <cmath>
+#include <cstring>
+
+#include <type_traits>
+
+
+// PI, para poder medir los angulos de direccion de movimiento de la pelota
+// usando radianes en fracciones de pi.
+static const float pi = 3.14159265358979f;
+
+// El estado se copia byte a byte en palabras de 32 bits
+static_assert(std::is_trivially_copyable<std::mt19937>::value, "the random engine must be trivially copyable");
+
+template <typename T>
+static void putWords(std::vector<std::uint32_t>& words, const T* values, std::size_t n) {
+    std::size_t offset = words.size();
+
+    words.resize(offset + (n*sizeof(T) + 3)/4, 0);
+    std::memcpy(&words[offset], values, n*sizeof(T));
+}
+
+template <typename T>
+static const std::uint32_t* getWords(const std::uint32_t* words, T* values, std::size_t n) {
+    std::memcpy(static_cast<void*>(values), words, n*sizeof(T));
+
+    return words + (n*sizeof(T) + 3)/4;
+}
+
+static std::size_t wordCount(std::size_t bytes) {
+    return (bytes + 3)/4;
+}
+
+// Choque de un solo rebote, h y b se llenan solo para las esquinas
+static Contact makeContact(ContactKind kind, std::size_t ball, std::size_t obstacle, sf::Vector2f position, float incomingAngle, float outgoingAngle) {
+    Contact contact;
+
+    contact.kind = kind;
+    contact.ball = ball;
+    contact.obstacle = obstacle;
+    contact.position = position;
+    contact.incomingAngle = incomingAngle;
+    contact.outgoingAngle = outgoingAngle;
+    contact.h = 0.f;
+    contact.b = 0.f;
+
+    return contact;
+}
+
+
+//----------------------------------------------------------------------------80
+//  SIMULACIÓN
+//----------------------------------------------------------------------------80
+Simulation::Simulation(const Scene& scene, sf::Vector2f origin, sf::Vector2f size, unsigned int seed) :
+    fieldOrigin(origin),
+    fieldSize(size),
+    ballRadius(0.f),
+    ballSpeed(0.f),
+    time(0.f),
+    elapsedTime(0.f),
+    specialEffect(false),
+    effect(NoEffect),
+    random(seed)
+{
+    balls.resize(scene.getBallCount());
+
+    for (auto& ball: balls) {
+        ball.position = fieldOrigin + 0.5f*fieldSize;
+        ball.angle = 0.f;
+    }
+
+    setScene(scene);
+    stats = SimulationStats();
+    stats.firstCornerTime = -1.f;
+}
+
+void Simulation::setScene(const Scene& scene) {
+    obstacleSize = scene.getObstacleSize();
+    ballRadius = scene.getBallRadius();
+    ballSpeed = scene.getBallSpeed();
+
+    // Si cambia el número de pelotas todas vuelven a salir del centro
+    if (balls.size() != scene.getBallCount()) {
+        balls.resize(scene.getBallCount());
+
+        for (auto& ball: balls) {
+            launch(ball);
+        }
+    }
+
+    std::size_t nObstacles = scene.getObstacleCount();
+    const sf::Vector2f* positions = scene.getObstacles();
+
+    basePositions.resize(nObstacles);
+    obstacles.resize(nObstacles);
+    angularVelocities.resize(nObstacles);
+    phases.resize(nObstacles);
+
+    for (std::size_t i = 0; i < nObstacles; i++) {
+        basePositions[i] = fieldOrigin + positions[i];
+        obstacles[i] = basePositions[i];
+
+        angularVelocities[i] = sf::Vector2f(static_cast<float>(random() % 90), static_cast<float>(random() % 90)) / 90.f;
+        phases[i] = static_cast<float>(random() % 10)*pi/40;
+    }
+
+    updateBounds();
+}
+
+void Simulation::updateBounds() {
+    bounds.resize(obstacles.size());
+
+    for (std::size_t i = 0; i < obstacles.size(); i++) {
+        bounds[i] = makeBounds(obstacles[i].x, obstacles[i].y, obstacleSize.x, obstacleSize.y);
+    }
+}
+
+void Simulation::launch(Ball& ball) {
+    ball.position = fieldOrigin + 0.5f*fieldSize;
+
+    // Elegimos el ángulo de inicio
+    do {
+        ball.angle = static_cast<float>(random() % 360) * pi / 180.f;
+    }
+    while (ball.angle < pi/3.f || (2.f*pi/3.f < ball.angle && ball.angle < 4.f*pi/3.f) || 5*pi/3.f < ball.angle);
+}
+
+void Simulation::start() {
+    for (auto& ball: balls) {
+        launch(ball);
+    }
+
+    elapsedTime = 0.f;
+    effect = NoEffect;
+    stats = SimulationStats();
+    stats.firstCornerTime = -1.f;
+}
+
+bool Simulation::step(float deltaTime, ContactList* contacts) {
+    bool colission = false;
+
+    elapsedTime += deltaTime;
+
+    if(specialEffect) {
+        time += deltaTime;
+
+        for (std::size_t i = 0; i < obstacles.size(); i++) {
+            obstacles[i].x = 30.f*std::sin(10.f*angularVelocities[i].x*time + phases[i]) + basePositions[i].x;
+            obstacles[i].y = 30.f*std::sin(10.f*angularVelocities[i].y*time) + basePositions[i].y;
+        }
+
+        updateBounds();
+    }
+
+    // Movemos las bolitas
+    float factor = ballSpeed * deltaTime;
+
+    for (std::size_t i = 0; i < balls.size(); i++) {
+        balls[i].position.x += std::cos(balls[i].angle) * factor;
+        balls[i].position.y += std::sin(balls[i].angle) * factor;
+
+        // La escena por defecto usa la versión con el número de obstáculos
+        // fijo
+        bool hit = (bounds.size() == defaultObstacleCount) ? collide<defaultObstacleCount>(i, contacts) : collide<0>(i, contacts);
+
+        if (hit) {
+            colission = true;
+        }
+    }
+
+    // Selecionar nueva animación
+    if (colission) {
+        effect = static_cast<Effect>(random() % nEffects);
+        stats.effects[effect]++;
+    }
+
+    return colission;
+}
+
+template <std::size_t Count>
+bool Simulation::collide(std::size_t index, ContactList* contacts) {
+    bool colission = false;
+    sf::Vector2f& position = balls[index].position;
+    float& ballAngle = balls[index].angle;
+
+    // Dirección antes de cada rebote
+    float incomingAngle = ballAngle;
+
+    float yError = 0;
+    float xError = 0;
+
+    float xLeft = fieldOrigin.x;
+    float xRight = fieldOrigin.x + fieldSize.x;
+    float yTop = fieldOrigin.y;
+    float yBottom = fieldOrigin.y + fieldSize.y;
+
+    // Verificamos choques con los extremos de la pantalla
+
+    // Si hay impacto con el borde izquierdo
+    if(position.x - ballRadius < xLeft) {
+        incomingAngle = ballAngle;
+        ballAngle = ((ballAngle < pi)?(1):(3))*pi - ballAngle;
+        xError = xLeft - position.x + ballRadius;
+        position.x += 2*xError;
+        stats.wallBounces++;
+        colission = true;
+
+        if (contacts != NULL) {
+            contacts->push_back(makeContact(WallContact, index, 0, position, incomingAngle, ballAngle));
+        }
+    }
+
+    // Si hay impacto con el borde derecho
+    if(position.x + ballRadius > xRight) {
+        incomingAngle = ballAngle;
+        ballAngle = ((ballAngle < pi)?(1):(3))*pi - ballAngle;
+        xError = position.x + ballRadius - xRight;
+        position.x -= 2*xError;
+        stats.wallBounces++;
+        colission = true;
+
+        if (contacts != NULL) {
+            contacts->push_back(makeContact(WallContact, index, 0, position, incomingAngle, ballAngle));
+        }
+    }
+
+    // Si hay impacto con el borde superior
+    if(position.y - ballRadius < yTop) {
+        incomingAngle = ballAngle;
+        ballAngle = 2*pi - ballAngle;
+        yError = yTop - position.y + ballRadius;
+        position.y += 2*yError;
+        stats.wallBounces++;
+        colission = true;
+
+        if (contacts != NULL) {
+            contacts->push_back(makeContact(WallContact, index, 0, position, incomingAngle, ballAngle));
+        }
+    }
+
+    // Si hay impacto con el borde inferior
+    if(position.y + ballRadius > yBottom) {
+        incomingAngle = ballAngle;
+        ballAngle = 2*pi - ballAngle;
+        yError = position.y + ballRadius - yBottom;
+        position.y -= 2*yError;
+        stats.wallBounces++;
+        colission = true;
+
+        if (contacts != NULL) {
+            contacts->push_back(makeContact(WallContact, index, 0, position, incomingAngle, ballAngle));
+        }
+    }
+
+    // Verificamos choques con los obstaculos
+    const std::size_t nObstacles = (Count > 0) ? Count : bounds.size();
+
+    for (std::size_t i = 0; i < nObstacles; i++) {
+        const ObstacleBounds& obstacle = bounds[i];
+
+        // Lados del obstáculo
+        xLeft = obstacle.left;
+        xRight = obstacle.right;
+        yTop = obstacle.top;
+        yBottom = obstacle.bottom;
+
+        // Descarte rápido: la pelota (con un pixel de margen para el
+        // redondeo) no toca el rectángulo del obstáculo, no puede haber
+        // choque con un lado ni con una esquina
+        if (position.x + ballRadius + 1.f <= xLeft || position.x - ballRadius - 1.f >= xRight ||
+            position.y + ballRadius + 1.f <= yTop || position.y - ballRadius - 1.f >= yBottom) {
+            continue;
+        }
+
+        // Si la pelota se acerca al cuadrado por la izquierda
+        if( position.x + ballRadius > xLeft &&
+            position.x + ballRadius < obstacle.centerX &&
+            position.y >= yTop &&
+            position.y <= yBottom
+        ) {
+            incomingAngle = ballAngle;
+            ballAngle = ((ballAngle < pi)?(1):(3))*pi - ballAngle;
+            xError = position.x + ballRadius - xLeft;
+            position.x -= 2*xError;
+            stats.obstacleBounces++;
+            colission = true;
+
+            if (contacts != NULL) {
+                contacts->push_back(makeContact(SideContact, index, i, position, incomingAngle, ballAngle));
+            }
+        }
+
+        // Si la pelota se acerca al cuadrado por la derecha
+        if( position.x - ballRadius < xRight &&
+            position.x - ballRadius > obstacle.centerX &&
+            position.y >= yTop &&
+            position.y <= yBottom
+        ) {
+            incomingAngle = ballAngle;
+            ballAngle = ((ballAngle < pi)?(1):(3))*pi - ballAngle;
+            xError = xRight - position.x + ballRadius;
+            position.x += 2*xError;
+            stats.obstacleBounces++;
+            colission = true;
+
+            if (contacts != NULL) {
+                contacts->push_back(makeContact(SideContact, index, i, position, incomingAngle, ballAngle));
+            }
+        }
+
+        // Si la pelota se acerca al cuadrado por arriba
+        if( position.y + ballRadius > yTop &&
+            position.y + ballRadius < obstacle.centerY &&
+            position.x >= xLeft &&
+            position.x <= xRight
+        ) {
+            incomingAngle = ballAngle;
+            ballAngle = 2*pi - ballAngle;
+            yError = position.y + ballRadius - yTop;
+            position.y -= 2*yError;
+            stats.obstacleBounces++;
+            colission = true;
+
+            if (contacts != NULL) {
+                contacts->push_back(makeContact(SideContact, index, i, position, incomingAngle, ballAngle));
+            }
+        }
+
+        // Si la pelota se acerca al cuadrado por abajo
+        if( position.y - ballRadius < yBottom &&
+            position.y - ballRadius > obstacle.centerY &&
+            position.x >= xLeft &&
+            position.x <= xRight
+        ) {
+            incomingAngle = ballAngle;
+            ballAngle = 2*pi - ballAngle;
+            yError = yBottom - position.y + ballRadius;
+            position.y += 2*yError;
+            stats.obstacleBounces++;
+            colission = true;
+
+            if (contacts != NULL) {
+                contacts->push_back(makeContact(SideContact, index, i, position, incomingAngle, ballAngle));
+            }
+        }
+
+        // Si la pelota se acerca al cuadrado por una esquina
+        // e impacta en ella
+        float xDistance = std::abs(obstacle.centerX - position.x);
+        float yDistance = std::abs(obstacle.centerY - position.y);
+        float cDistance = std::sqrt(std::pow(xDistance - obstacle.halfWidth, 2.f) + std::pow(yDistance - obstacle.halfHeight, 2.f));
+        float h = 0.f;
+        float e = 0.f;
+        float b = 0.f;
+
+        if (cDistance >= ballRadius) {
+            continue;
+        }
+
+        bool cornerHit = false;
+
+        // La pelota llega por la esquina superior izquierda
+        if(position.x < xLeft && position.y < yTop) {
+            h = xLeft*std::sin(ballAngle) - yTop*std::cos(ballAngle) + position.y*std::cos(ballAngle) - position.x*std::sin(ballAngle);
+            h = std::abs(h);
+
+            incomingAngle = ballAngle;
+
+            b = std::asin(h/ballRadius);
+            e = ballRadius*std::cos(b) - std::sqrt(cDistance*cDistance - h*h);
+            position -= e*sf::Vector2f(std::cos(ballAngle), std::sin(ballAngle));
+
+            if(0 <= ballAngle && ballAngle < pi/2) {
+                ballAngle = ballAngle + 2*b + pi;
+            }
+            if (pi/2 <= ballAngle && ballAngle < pi) {
+                ballAngle = pi + ballAngle - 2*b;
+            }
+            if (3*pi/2 <= ballAngle && ballAngle < 2*pi) {
+                ballAngle = ballAngle + 2*b - pi;
+            }
+
+            position += e*sf::Vector2f(std::cos(ballAngle), std::sin(ballAngle));
+            cornerHit = true;
+        }
+
+        // La pelota llega por la esquina inferior izquieda
+        if(position.x < xLeft && position.y > yBottom) {
+            h = xLeft*std::sin(ballAngle) - yBottom*std::cos(ballAngle) + position.y*std::cos(ballAngle) - position.x*std::sin(ballAngle);
+            h = std::abs(h);
+
+            incomingAngle = ballAngle;
+
+            b = std::asin(h/ballRadius);
+            e = ballRadius*std::cos(b) - std::sqrt(cDistance*cDistance - h*h);
+            position -= e*sf::Vector2f(std::cos(ballAngle), std::sin(ballAngle));
+
+            if(0 <= ballAngle && ballAngle < pi/2) {
+                ballAngle = pi + ballAngle - 2*b;
+            }
+            else if (pi/2 <= ballAngle && ballAngle < 3*pi/2) {
+                ballAngle = pi + ballAngle + 2*b;
+            } else {
+                ballAngle = ballAngle - pi + 2*b;
+            }
+
+            position += e*sf::Vector2f(std::cos(ballAngle), std::sin(ballAngle));
+            cornerHit = true;
+        }
+
+        // La pelota llega por la esquina inferior derecha
+        if(position.x > xRight && position.y > yBottom) {
+            h = xRight*std::sin(ballAngle) - yBottom*std::cos(ballAngle) + position.y*std::cos(ballAngle) - position.x*std::sin(ballAngle);
+            h = std::abs(h);
+
+            incomingAngle = ballAngle;
+
+            b = std::asin(h/ballRadius);
+            e = ballRadius*std::cos(b) - std::sqrt(cDistance*cDistance - h*h);
+            position -= e*sf::Vector2f(std::cos(ballAngle), std::sin(ballAngle));
+
+            if(0 <= ballAngle && ballAngle < pi/2) {
+                ballAngle = pi + ballAngle + 2*b;
+            }
+            else if (pi/2 <= ballAngle && ballAngle < 3*pi/2) {
+                ballAngle = pi + ballAngle - 2*b;
+            } else {
+                ballAngle = ballAngle - pi - 2*b;
+            }
+
+            position += e*sf::Vector2f(std::cos(ballAngle), std::sin(ballAngle));
+            cornerHit = true;
+        }
+
+        // La pelota llega por la esquina superior derecha
+        if(position.x > xRight && position.y < yTop) {
+            h = xRight*std::sin(ballAngle) - yTop*std::cos(ballAngle) + position.y*std::cos(ballAngle) - position.x*std::sin(ballAngle);
+            h = std::abs(h);
+
+            incomingAngle = ballAngle;
+
+            b = std::asin(h/ballRadius);
+            e = ballRadius*std::cos(b) - std::sqrt(cDistance*cDistance - h*h);
+            position -= e*sf::Vector2f(std::cos(ballAngle), std::sin(ballAngle));
+
+            if(ballAngle <= pi) {
+                ballAngle = pi + ballAngle + 2*b;
+            }
+            else {
+                ballAngle = pi + ballAngle - 2*b;
+            }
+
+            position += e*sf::Vector2f(std::cos(ballAngle), std::sin(ballAngle));
+            cornerHit = true;
+        }
+
+        if (cornerHit) {
+            if (stats.firstCornerTime < 0.f) {
+                stats.firstCornerTime = elapsedTime;
+            }
+
+            stats.cornerHits++;
+            colission = true;
+
+            if (contacts != NULL) {
+                Contact contact = makeContact(CornerContact, index, i, position, incomingAngle, ballAngle);
+                contact.h = h;
+                contact.b = b;
+                contacts->push_back(contact);
+            }
+        }
+    }
+
+    return colission;
+}
+
+void Simulation::setSpecialEffect(bool enabled) {
+    specialEffect = enabled;
+}
+
+bool Simulation::hasSpecialEffect() const {
+    return specialEffect;
+}
+
+std::size_t Simulation::getBallCount() const {
+    return balls.size();
+}
+
+const Ball& Simulation::getBall(std::size_t index) const {
+    return balls[index];
+}
+
+std::size_t Simulation::getObstacleCount() const {
+    return obstacles.size();
+}
+
+const sf::Vector2f& Simulation::getObstacle(std::size_t index) const {
+    return obstacles[index];
+}
+
+sf::Vector2f Simulation::getObstacleSize() const {
+    return obstacleSize;
+}
+
+float Simulation::getBallRadius() const {
+    return ballRadius;
+}
+
+Effect Simulation::getEffect() const {
+    return effect;
+}
+
+float Simulation::getElapsedTime() const {
+    return elapsedTime;
+}
+
+const SimulationStats& Simulation::getStats() const {
+    return stats;
+}
+
+void Simulation::saveState(std::vector<std::uint32_t>& words) const {
+    std::uint32_t counts[2] = {
+        static_cast<std::uint32_t>(balls.size()),
+        static_cast<std::uint32_t>(obstacles.size())
+    };
+    std::int32_t flags[2] = {specialEffect ? 1 : 0, static_cast<std::int32_t>(effect)};
+    float times[2] = {time, elapsedTime};
+
+    words.clear();
+    putWords(words, counts, 2);
+    putWords(words, flags, 2);
+    putWords(words, times, 2);
+    putWords(words, &stats, 1);
+    putWords(words, &random, 1);
+    putWords(words, balls.data(), balls.size());
+    putWords(words, obstacles.data(), obstacles.size());
+}
+
+bool Simulation::loadState(const std::uint32_t* words, std::size_t size) {
+    std::size_t expected = 6 + wordCount(sizeof(SimulationStats)) + wordCount(sizeof(std::mt19937))
+                         + wordCount(balls.size()*sizeof(Ball)) + wordCount(obstacles.size()*sizeof(sf::Vector2f));
+
+    if (size != expected || words[0] != balls.size() || words[1] != obstacles.size()) {
+        return false;
+    }
+
+    std::int32_t flags[2];
+    float times[2];
+
+    words = getWords(words + 2, flags, 2);
+    words = getWords(words, times, 2);
+    words = getWords(words, &stats, 1);
+    words = getWords(words, &random, 1);
+    words = getWords(words, balls.data(), balls.size());
+    getWords(words, obstacles.data(), obstacles.size());
+
+    specialEffect = flags[0] != 0;
+    effect = static_cast<Effect>(flags[1]);
+    time = times[0];
+    elapsedTime = times[1];
+
+    updateBounds();
+
+    return true;
+}
@@ -0,0 +1,193 @@
+//****************************************************************************80
+//
+//  PROGRAM    :
+//               GeoT
+//
+//  PURPOSE    :
+//               Program to show Goemetric Transformations as an applied
+//               exploration SFML multimedia library.
+//
+//  PROGRAMMER :
+//               Martín Josemaría <martin.vuelta@gmail.com>
+//
+//               * Software Development and Research
+//                 SoftButterfly
+//                 Lima - Peru
+//
+//               * Faculty of Physical Science
+//                 Universidad Nacional Mayor de San Marcos
+//                 Lima - Peru
+//
+//  FILE       :
+//               simulation.hpp
+//
+//  DESCRIPTION:
+//               Ball and obstacle physics, independent of the window so it
+//               can run headless.
+//
+//****************************************************************************80
+
+#ifndef GEOT_SIMULATION_HPP
+#define GEOT_SIMULATION_HPP
+
+#include <SFML/System.hpp>
+
+#include "layout.hpp"
+#include "memory.hpp"
+#include "scene.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <random>
+#include <vector>
+
+
+//----------------------------------------------------------------------------80
+//  TIPOS
+//----------------------------------------------------------------------------80
+// Transformación activa, se elige al azar en cada choque
+enum Effect {
+    NoEffect = -1,
+    Homothecy = 0,
+    Symmetry = 1,
+    Rotation = 2
+};
+
+const int nEffects = 3;
+
+struct Ball {
+    sf::Vector2f position;
+    float angle;
+};
+
+// Choque registrado durante un paso de la simulación
+enum ContactKind {
+    WallContact,
+    SideContact,
+    CornerContact
+};
+
+struct Contact {
+    ContactKind kind;
+    std::size_t ball;
+
+    // Obstáculo con el que choca (no se usa para las paredes)
+    std::size_t obstacle;
+
+    // Posición y ángulo de la pelota antes y después del rebote
+    sf::Vector2f position;
+    float incomingAngle;
+    float outgoingAngle;
+
+    // Solo esquinas: distancia del centro de la pelota a la recta de impacto
+    // y ángulo de corte
+    float h;
+    float b;
+};
+
+// Los choques de un cuadro viven en la arena del cuadro
+typedef FrameVector<Contact> ContactList;
+
+// Contadores acumulados desde start()
+struct SimulationStats {
+    unsigned long wallBounces;
+    unsigned long obstacleBounces;
+    unsigned long cornerHits;
+    unsigned long effects[nEffects];
+
+    // Tiempo simulado hasta el primer choque con una esquina (negativo si
+    // todavía no ocurre)
+    float firstCornerTime;
+};
+
+
+//----------------------------------------------------------------------------80
+//  SIMULACIÓN
+//----------------------------------------------------------------------------80
+// Las posiciones están en coordenadas de la ventana: el campo de juego es el
+// rectángulo [fieldOrigin, fieldOrigin + fieldSize] y las posiciones de la
+// escena son relativas a fieldOrigin.
+class Simulation {
+public:
+    Simulation(const Scene& scene, sf::Vector2f origin, sf::Vector2f size, unsigned int seed);
+
+    // Vuelve a leer los obstáculos y tamaños de la escena. Las pelotas se
+    // conservan mientras la escena tenga el mismo número de pelotas, si no
+    // todas vuelven a salir del centro.
+    void setScene(const Scene& scene);
+
+    // Coloca las pelotas en el centro del campo con ángulos al azar
+    void start();
+
+    // Avanza deltaTime segundos. Devuelve verdadero si hubo algún choque, en
+    // ese caso se elige una nueva transformación. Si contacts no es nulo se
+    // agregan los choques del paso.
+    bool step(float deltaTime, ContactList* contacts = NULL);
+
+    void setSpecialEffect(bool enabled);
+    bool hasSpecialEffect() const;
+
+    std::size_t getBallCount() const;
+    const Ball& getBall(std::size_t index) const;
+
+    std::size_t getObstacleCount() const;
+    const sf::Vector2f& getObstacle(std::size_t index) const;
+
+    sf::Vector2f getObstacleSize() const;
+    float getBallRadius() const;
+
+    Effect getEffect() const;
+    float getElapsedTime() const;
+    const SimulationStats& getStats() const;
+
+    // Estado que cambia al simular (pelotas, obstáculos, transformación
+    // activa, contadores y generador de números al azar) como palabras de 32
+    // bits, para el historial. loadState devuelve falso si el estado no
+    // corresponde al número de pelotas y obstáculos actual.
+    void saveState(std::vector<std::uint32_t>& words) const;
+    bool loadState(const std::uint32_t* words, std::size_t size);
+
+private:
+    // Count es el número de obstáculos conocido al compilar (el bucle se
+    // desenrolla) o cero para cualquier número de obstáculos
+    template <std::size_t Count>
+    bool collide(std::size_t index, ContactList* contacts);
+
+    void updateBounds();
+
+    // Coloca la pelota en el centro del campo con un ángulo al azar
+    void launch(Ball& ball);
+
+    sf::Vector2f fieldOrigin;
+    sf::Vector2f fieldSize;
+
+    sf::Vector2f obstacleSize;
+    float ballRadius;
+    float ballSpeed;
+
+    std::vector<Ball> balls;
+
+    // Posición de reposo, posición actual, velocidad angular y fase de cada
+    // obstáculo
+    std::vector<sf::Vector2f> basePositions;
+    std::vector<sf::Vector2f> obstacles;
+    std::vector<sf::Vector2f> angularVelocities;
+    std::vector<float> phases;
+
+    // Lados de cada obstáculo, se recalculan solo cuando los obstáculos se
+    // mueven
+    std::vector<ObstacleBounds> bounds;
+
+    // Tiempo acumulado para el efecto especial
+    float time;
+    float elapsedTime;
+    bool specialEffect;
+
+    Effect effect;
+    SimulationStats stats;
+
+    std::mt19937 random;
+};
+
+#endif